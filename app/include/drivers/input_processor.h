@@ -46,8 +46,28 @@ typedef int (*zmk_input_processor_handle_event_callback_t)(const struct device *
                                                            uint32_t param1, uint32_t param2,
                                                            struct zmk_input_processor_state *state);
 
+/**
+ * What a processor does to an event of one type and code, for processors that only remap the code
+ * and scale the value by mul / div. The sign of mul inverts the value.
+ */
+struct zmk_input_processor_affine {
+    uint16_t code;
+    int32_t mul;
+    int32_t div;
+};
+
+/**
+ * Describe the processor's effect on an event of the given type and code. The affine is passed in
+ * as the identity for that code, and is left unchanged if the processor doesn't touch the event.
+ */
+typedef int (*zmk_input_processor_get_affine_callback_t)(const struct device *dev, uint8_t type,
+                                                         uint32_t param1, uint32_t param2,
+                                                         struct zmk_input_processor_affine *affine);
+
 __subsystem struct zmk_input_processor_driver_api {
     zmk_input_processor_handle_event_callback_t handle_event;
+    // Optional, lets input listeners fuse the processor with its neighbours.
+    zmk_input_processor_get_affine_callback_t get_affine;
 };
 
 __syscall int zmk_input_processor_handle_event(const struct device *dev, struct input_event *event,
@@ -68,4 +88,17 @@ static inline int z_impl_zmk_input_processor_handle_event(const struct device *d
     return api->handle_event(dev, event, param1, param2, state);
 }
 
+static inline int zmk_input_processor_get_affine(const struct device *dev, uint8_t type,
+                                                 uint32_t param1, uint32_t param2,
+                                                 struct zmk_input_processor_affine *affine) {
+    const struct zmk_input_processor_driver_api *api =
+        (const struct zmk_input_processor_driver_api *)dev->api;
+
+    if (api->get_affine == NULL) {
+        return -ENOTSUP;
+    }
+
+    return api->get_affine(dev, type, param1, param2, affine);
+}
+
 #include <syscalls/input_processor.h>
@@ -18,6 +18,9 @@ struct zmk_behavior_binding {
     zmk_behavior_local_id_t local_id;
 #endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
     const char *behavior_dev;
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    const struct device *behavior_device;
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
     uint32_t param1;
     uint32_t param2;
 };
@@ -45,6 +48,26 @@ struct zmk_behavior_binding_event {
  */
 const struct device *zmk_behavior_get_binding(const char *name);
 
+/**
+ * @brief Get the behavior device for a binding.
+ *
+ * @param binding The binding to get the behavior device for.
+ *
+ * @retval Pointer to the device structure for the binding's behavior, using the device already
+ * resolved in the binding if there is one, and otherwise looking it up by name.
+ * @retval NULL if the behavior is not found or its initialization function failed.
+ */
+const struct device *zmk_behavior_get_binding_device(const struct zmk_behavior_binding *binding);
+
+/**
+ * @brief Resolve and store the behavior device in a binding, based on its @p behavior_dev field.
+ *
+ * This should be called whenever the behavior of a long-lived binding is changed at runtime.
+ *
+ * @param binding The binding to update.
+ */
+void zmk_behavior_resolve_binding_device(struct zmk_behavior_binding *binding);
+
 /**
  * @brief Invoke a behavior given its binding and invoking event details.
  *
@@ -58,6 +81,21 @@ const struct device *zmk_behavior_get_binding(const char *name);
 int zmk_behavior_invoke_binding(const struct zmk_behavior_binding *src_binding,
                                 struct zmk_behavior_binding_event event, bool pressed);
 
+/**
+ * @brief Invoke a behavior given its binding and the behavior device it was already resolved to.
+ *
+ * @param src_binding Behavior binding to invoke.
+ * @param behavior The device for the binding's behavior, or NULL if it couldn't be found.
+ * @param event The binding event struct containing details of the event that invoked it.
+ * @param pressed Whether the binding is pressed or released.
+ *
+ * @retval 0 If successful.
+ * @retval Negative errno code if failure.
+ */
+int zmk_behavior_invoke_resolved_binding(const struct zmk_behavior_binding *src_binding,
+                                         const struct device *behavior,
+                                         struct zmk_behavior_binding_event event, bool pressed);
+
 /**
  * @brief Get a local ID for a behavior from its @p name field.
  *
@@ -77,3 +115,23 @@ zmk_behavior_local_id_t zmk_behavior_get_local_id(const char *name);
  * @retval NULL if the behavior is not found or its initialization function failed.
  */
 const char *zmk_behavior_find_behavior_name_from_local_id(zmk_behavior_local_id_t local_id);
+
+/**
+ * @brief Get the local ID of a behavior from its device.
+ *
+ * @param dev Behavior device to search for.
+ *
+ * @retval The local ID value of the behavior.
+ * @retval UINT16_MAX if the behavior is not found or its initialization function failed.
+ */
+zmk_behavior_local_id_t zmk_behavior_get_local_id_for_device(const struct device *dev);
+
+/**
+ * @brief Get a behavior device from its @p local_id .
+ *
+ * @param local_id Behavior local ID used to search for the behavior
+ *
+ * @retval Pointer to the device structure for the behavior associated with that local ID.
+ * @retval NULL if the behavior is not found or its initialization function failed.
+ */
+const struct device *zmk_behavior_get_device_from_local_id(zmk_behavior_local_id_t local_id);
@@ -33,6 +33,13 @@ bt_addr_le_t *zmk_ble_profile_address(uint8_t index);
 bt_addr_le_t *zmk_ble_active_profile_addr(void);
 struct bt_conn *zmk_ble_active_profile_conn(void);
 
+/**
+ * @brief Get the connection interval of the active profile, in microseconds.
+ *
+ * @retval The connection interval, or 0 if the active profile isn't connected.
+ */
+uint32_t zmk_ble_active_profile_conn_interval_us(void);
+
 bool zmk_ble_profile_is_connected(uint8_t index);
 bool zmk_ble_profile_is_open(uint8_t index);
 
@@ -9,9 +9,17 @@
 #include <stddef.h>
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
+#include <zephyr/sys/iterable_sections.h>
+
+struct zmk_event_listener_range {
+    uint16_t start;
+    uint16_t len;
+};
 
 struct zmk_event_type {
     const char *name;
+    size_t size;
+    struct zmk_event_listener_range *listeners;
 };
 
 typedef struct {
@@ -33,6 +41,15 @@ struct zmk_event_subscription {
     const struct zmk_listener *listener;
 };
 
+/*
+ * One slot is emitted per subscription, and the event manager fills them in at boot so that the
+ * listeners of each event type are contiguous, in subscription order. Dispatch then only visits
+ * the listeners for the raised event type.
+ */
+struct zmk_event_listener_slot {
+    const struct zmk_listener *listener;
+};
+
 #define ZMK_EVENT_DECLARE(event_type)                                                              \
     struct event_type##_event {                                                                    \
         zmk_event_t header;                                                                        \
@@ -44,7 +61,11 @@ struct zmk_event_subscription {
     extern const struct zmk_event_type zmk_event_##event_type;
 
 #define ZMK_EVENT_IMPL(event_type)                                                                 \
-    const struct zmk_event_type zmk_event_##event_type = {.name = STRINGIFY(event_type)};          \
+    static struct zmk_event_listener_range zmk_event_listeners_##event_type;                       \
+    const struct zmk_event_type zmk_event_##event_type = {                                         \
+        .name = STRINGIFY(event_type),                                                             \
+        .size = sizeof(struct event_type##_event),                                                 \
+        .listeners = &zmk_event_listeners_##event_type};                                           \
     const struct zmk_event_type *zmk_event_ref_##event_type __used                                 \
         __attribute__((__section__(".event_type"))) = &zmk_event_##event_type;                     \
     struct event_type##_event copy_raised_##event_type(const struct event_type *ev) {              \
@@ -70,7 +91,9 @@ struct zmk_event_subscription {
         __attribute__((__section__(".event_subscription"))) = {                                    \
             .event_type = &zmk_event_##ev_type,                                                    \
             .listener = &zmk_listener_##mod,                                                       \
-    };
+    };                                                                                             \
+    STRUCT_SECTION_ITERABLE(zmk_event_listener_slot,                                               \
+                            _CONCAT(_CONCAT(_CONCAT(zmk_event_listener_slot_, mod), _), ev_type));
 
 #define ZMK_EVENT_RAISE(ev) zmk_event_manager_raise(&(ev).header)
 
@@ -84,4 +107,51 @@ struct zmk_event_subscription {
 int zmk_event_manager_raise(zmk_event_t *event);
 int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener);
 int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener);
-int zmk_event_manager_release(zmk_event_t *event);
\ No newline at end of file
+int zmk_event_manager_release(zmk_event_t *event);
+
+/*
+ * Events captured by listeners (hold-taps, combos, ...) are stored in a shared, fixed-size ring
+ * owned by the event manager. A listener that wants to hold on to an event calls
+ * zmk_event_manager_capture() and returns ZMK_EV_EVENT_CAPTURED; the returned handle points at the
+ * stored copy. Captured events are dispatched again straight from the ring, and capturing an event
+ * that is already stored there (e.g. one being replayed) keeps it in its slot, so an event is
+ * copied at most once no matter how many listeners intercept it. A slot is freed once its event
+ * has been dispatched again without being captured, or when it is discarded.
+ */
+
+// Largest event that fits in a capture slot, checked when an event is captured.
+#define ZMK_EVENT_CAPTURE_SLOT_SIZE 48
+
+zmk_event_t *zmk_event_manager_capture(const zmk_event_t *event);
+
+// Continue dispatching a captured event with the listener after the one that captured it.
+int zmk_event_manager_release_captured(zmk_event_t *captured);
+
+// Dispatch a captured event again starting with the listener that captured it.
+int zmk_event_manager_replay_captured(zmk_event_t *captured);
+
+// Dispatch a captured event again starting with the first listener.
+int zmk_event_manager_reraise_captured(zmk_event_t *captured);
+
+void zmk_event_manager_discard_captured(zmk_event_t *captured);
+
+// Iterate, oldest first, over the events currently held by the given listener.
+zmk_event_t *zmk_event_manager_next_captured(const struct zmk_listener *listener,
+                                             const zmk_event_t *prev);
+
+/*
+ * Mark every event currently held by the listener for replay. The marked events are then returned
+ * oldest first by zmk_event_manager_next_replay() until each one has been passed to
+ * zmk_event_manager_replay_captured(). Events captured after this call, including marked events
+ * that are captured again while being replayed, are not part of the batch.
+ */
+void zmk_event_manager_begin_replay(const struct zmk_listener *listener);
+zmk_event_t *zmk_event_manager_next_replay(const struct zmk_listener *listener);
+
+// Continue dispatching the event the calling listener is handling, in place and without copying
+// it, with the listeners after the caller. The caller then returns ZMK_EV_EVENT_CAPTURED.
+int zmk_event_manager_continue(const zmk_event_t *event);
+
+// Dispatch the event the calling listener is handling again, in place, from the first listener.
+// The caller then returns ZMK_EV_EVENT_CAPTURED.
+int zmk_event_manager_reraise(const zmk_event_t *event);
@@ -383,6 +383,10 @@ void zmk_hid_mouse_clear(void);
 struct zmk_hid_keyboard_report *zmk_hid_get_keyboard_report(void);
 struct zmk_hid_consumer_report *zmk_hid_get_consumer_report(void);
 
+// Whether the report with the given ID changed since its dirty flag was last cleared.
+bool zmk_hid_report_is_dirty(uint8_t report_id);
+void zmk_hid_report_clear_dirty(uint8_t report_id);
+
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
 zmk_hid_boot_report_t *zmk_hid_get_boot_report();
 #endif
@@ -9,9 +9,30 @@
 #include <zmk/keys.h>
 #include <zmk/hid.h>
 
+enum zmk_hog_report_type {
+    ZMK_HOG_REPORT_TYPE_KEYBOARD,
+    ZMK_HOG_REPORT_TYPE_CONSUMER,
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    ZMK_HOG_REPORT_TYPE_MOUSE,
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
+
+struct zmk_hog_report_queue_stats {
+    // Reports currently waiting to be sent, and the most that have ever been waiting
+    uint8_t depth;
+    uint8_t max_depth;
+    // Reports folded into an already queued report without losing any state
+    uint32_t coalesced;
+    // Reports that replaced a queued report because the queue was full
+    uint32_t dropped;
+};
+
 int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *body);
 int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *body);
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *body);
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+
+int zmk_hog_get_report_queue_stats(enum zmk_hog_report_type type,
+                                   struct zmk_hog_report_queue_stats *stats);
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2025 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/types.h>
+
+/*
+ * Bucket 0 counts samples under 1us, and bucket N counts samples in [2^(N-1), 2^N) us. The last
+ * bucket also collects everything slower than that, so the histogram covers up to ~16ms.
+ */
+#define ZMK_LATENCY_HISTOGRAM_BUCKETS 16
+
+enum zmk_latency_stage {
+    // Position event handed to the event manager
+    ZMK_LATENCY_STAGE_DISPATCH,
+    // HID report updated by the HID listener, before it is handed to the endpoint
+    ZMK_LATENCY_STAGE_REPORT_BUILD,
+    // Report delivered by the transport (HOG notify sent, USB IN endpoint ready)
+    ZMK_LATENCY_STAGE_TRANSPORT_COMPLETE,
+
+    ZMK_LATENCY_STAGE_COUNT,
+};
+
+struct zmk_latency_histogram {
+    uint32_t buckets[ZMK_LATENCY_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+};
+
+/**
+ * Mark the moment a key transition was captured. Every stage records at most one sample relative
+ * to the most recent capture.
+ */
+void zmk_latency_capture(void);
+
+void zmk_latency_record(enum zmk_latency_stage stage);
+
+int zmk_latency_get_histogram(enum zmk_latency_stage stage, struct zmk_latency_histogram *hist);
+
+void zmk_latency_reset(void);
+
+void zmk_latency_log_histograms(void);
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/bluetooth/conn.h>
+
+enum zmk_split_bt_conn_param_profile {
+    ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_LATENCY,
+    ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_POWER,
+};
+
+struct zmk_split_bt_conn_param_stats {
+    enum zmk_split_bt_conn_param_profile profile;
+    // Interval (in 1.25ms units) most recently reported by the controller for a split connection.
+    uint16_t interval;
+    // Profile switches applied to the split connections.
+    uint32_t switches;
+    // Profile switches held back because the previous update was too recent.
+    uint32_t deferred;
+    // Connection parameter update requests rejected by the stack.
+    uint32_t update_failures;
+};
+
+struct zmk_split_bt_central_source_stats {
+    // Timestamped events received from the peripheral.
+    uint32_t events;
+    // Events raised ahead of events from another peripheral that arrived before them.
+    uint32_t reordered;
+    // Events that arrived after a more recent event had already been raised.
+    uint32_t late;
+    // Smoothed variation of the capture to arrival delay, as estimated in RFC 3550.
+    uint16_t jitter_ms;
+    uint16_t max_transit_ms;
+};
+
+// Reorder statistics for the peripheral in the given slot, or -ENOTSUP if reordering is disabled.
+int zmk_split_bt_central_get_source_stats(uint8_t source,
+                                          struct zmk_split_bt_central_source_stats *stats);
+
+// Connection parameters of the current profile, used when connecting to a new peripheral.
+const struct bt_le_conn_param *zmk_split_bt_central_conn_param(void);
+
+enum zmk_split_bt_conn_param_profile zmk_split_bt_central_get_conn_param_profile(void);
+void zmk_split_bt_central_get_conn_param_stats(struct zmk_split_bt_conn_param_stats *stats);
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <zephyr/sys/util.h>
+
 #include <zmk/events/sensor_event.h>
 #include <zmk/sensors.h>
 
@@ -31,9 +33,54 @@ struct zmk_split_run_behavior_payload {
     char behavior_dev[ZMK_SPLIT_RUN_BEHAVIOR_DEV_LEN];
 } __packed;
 
+struct zmk_split_run_behavior_by_local_id_payload {
+    struct zmk_split_run_behavior_data data;
+    uint16_t local_id;
+} __packed;
+
+#define ZMK_SPLIT_POSITION_EVENTS_VERSION 1
+
+/*
+ * Each position events notification is a header followed by `count` records, oldest first.
+ * Records store the milliseconds elapsed since the previous record in the same notification,
+ * and the header stores how long ago the last record happened when the notification was sent,
+ * so the receiver can reconstruct the timing of every record against its own clock.
+ */
+struct zmk_split_position_events_header {
+    uint8_t version;
+    uint8_t count;
+    uint16_t age;
+} __packed;
+
+#define ZMK_SPLIT_POSITION_EVENT_PRESSED BIT(15)
+#define ZMK_SPLIT_POSITION_EVENT_DELTA_MAX 0x7FFF
+
+struct zmk_split_position_event_record {
+    uint8_t position;
+    uint16_t state_delta;
+} __packed;
+
 struct zmk_split_input_event_payload {
     uint8_t type;
     uint16_t code;
     uint32_t value;
     uint8_t sync;
 } __packed;
+
+struct zmk_split_bt_position_stats {
+    // Position state snapshots, position events, or counted transitions waiting to be notified to
+    // the central.
+    uint8_t depth;
+    uint8_t max_depth;
+    // Transitions folded into an already queued snapshot, or sent in the same event notification
+    // as an earlier one, without losing a state.
+    uint32_t coalesced;
+    // Transitions counted per position because the snapshot queue was full, to be queued once it
+    // has room.
+    uint32_t state_overflows;
+    // Position events counted per position because the event queue was full, to be sent once it
+    // has drained.
+    uint32_t event_overflows;
+};
+
+void zmk_split_bt_get_position_stats(struct zmk_split_bt_position_stats *stats);
@@ -37,6 +37,14 @@ int zmk_split_transport_central_peripheral_event_handler(
     const struct zmk_split_transport_central *transport, uint8_t source,
     struct zmk_split_transport_peripheral_event ev);
 
+/**
+ * Handle an event from a peripheral that occurred at @p timestamp, as opposed to when it
+ * was received, for transports that can recover the original timing of events.
+ */
+int zmk_split_transport_central_peripheral_event_handler_at(
+    const struct zmk_split_transport_central *transport, uint8_t source,
+    struct zmk_split_transport_peripheral_event ev, int64_t timestamp);
+
 #define ZMK_SPLIT_TRANSPORT_CENTRAL_REGISTER(name, _api, priority)                                 \
     STRUCT_SECTION_ITERABLE_NAMED(zmk_split_transport_central, _CONCAT(priority, _##name),         \
                                   name) = {                                                        \
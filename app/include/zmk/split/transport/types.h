@@ -66,6 +66,7 @@ enum zmk_split_transport_central_command_type {
     ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
     ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT,
     ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS,
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR_BY_LOCAL_ID,
 } __packed;
 
 struct zmk_split_transport_central_command {
@@ -80,6 +81,14 @@ struct zmk_split_transport_central_command {
             uint8_t state;
         } invoke_behavior;
 
+        struct {
+            uint16_t local_id;
+            uint32_t param1, param2;
+            uint32_t position;
+            uint8_t event_source;
+            uint8_t state;
+        } invoke_behavior_by_local_id;
+
         struct {
             uint8_t layout_idx;
         } set_physical_layout;
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/dlist.h>
+
+/*
+ * Behavior timeouts. All pending timers are kept in one list sorted by deadline, driven by a
+ * single delayable work item on the system work queue, so starting or cancelling a timer while
+ * typing rarely touches a kernel timeout. Timers that are due at the same time expire together,
+ * in deadline order, with ties expiring in the order they were started.
+ */
+
+#define ZMK_TIMER_NO_DEADLINE INT64_MAX
+
+struct zmk_timer;
+
+typedef void (*zmk_timer_handler_t)(struct zmk_timer *timer);
+
+struct zmk_timer {
+    sys_dnode_t node;
+    // Uptime in milliseconds, comparable with k_uptime_get() and event timestamps.
+    int64_t deadline;
+    zmk_timer_handler_t handler;
+};
+
+#define ZMK_TIMER_DEFINE(name, handler_fn)                                                         \
+    struct zmk_timer name = {.deadline = ZMK_TIMER_NO_DEADLINE, .handler = handler_fn}
+
+void zmk_timer_init(struct zmk_timer *timer, zmk_timer_handler_t handler);
+
+/**
+ * Start the timer so it expires at the given uptime, rescheduling it if it is already pending.
+ * Deadlines in the past expire on the next run of the system work queue.
+ */
+void zmk_timer_start_at(struct zmk_timer *timer, int64_t deadline);
+
+static inline void zmk_timer_start(struct zmk_timer *timer, int32_t ms) {
+    zmk_timer_start_at(timer, k_uptime_get() + ms);
+}
+
+/**
+ * Stop a pending timer. Handlers run on the system work queue, so a timer cancelled from there
+ * never fires afterwards. From other threads, -EINPROGRESS is returned if the handler is running
+ * at that moment, and 0 otherwise.
+ */
+int zmk_timer_cancel(struct zmk_timer *timer);
+
+bool zmk_timer_is_pending(const struct zmk_timer *timer);
+
+/**
+ * The uptime of the earliest pending deadline, or ZMK_TIMER_NO_DEADLINE if no timer is pending.
+ */
+int64_t zmk_timer_next_deadline(void);
@@ -8,9 +8,25 @@
 
 #include <stdint.h>
 
+struct zmk_usb_hid_report_stats {
+    // Reports currently waiting for the endpoint, across all report types.
+    uint8_t depth;
+    uint8_t max_depth;
+    // Reports sent while a previous report was still waiting to be read by the host.
+    uint32_t stalls;
+    // Reports folded into an already queued report without losing a state.
+    uint32_t coalesced;
+    // Reports that overwrote the newest queued report because its queue was full.
+    uint32_t dropped;
+};
+
 int zmk_usb_hid_send_keyboard_report(void);
 int zmk_usb_hid_send_consumer_report(void);
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_usb_hid_send_mouse_report(void);
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 void zmk_usb_hid_set_protocol(uint8_t protocol);
+
+// Discard queued reports, e.g. after a bus reset where the in-flight report will never complete.
+void zmk_usb_hid_reset_reports(void);
+void zmk_usb_hid_get_report_stats(struct zmk_usb_hid_report_stats *stats);
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2025 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_uart_emul_mock
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+struct uart_emul_mock_config {
+    uint16_t startup_delay;
+    uint16_t event_period;
+    const uint8_t *data;
+    const uint32_t *chunk_lengths;
+    size_t chunks_len;
+};
+
+struct uart_emul_mock_data {
+    const struct device *dev;
+    uart_callback_t callback;
+    void *user_data;
+
+    uint8_t *rx_buf;
+    size_t rx_buf_len;
+    // Bytes received into rx_buf so far, and how many of them were reported with UART_RX_RDY.
+    size_t rx_len;
+    size_t rx_reported;
+    uint8_t *rx_next_buf;
+    size_t rx_next_buf_len;
+
+    size_t chunk_index;
+    size_t data_offset;
+    struct k_work_delayable rx_work;
+
+    const uint8_t *tx_buf;
+    size_t tx_len;
+    struct k_work tx_work;
+};
+
+#if IS_ENABLED(CONFIG_UART_ASYNC_API)
+
+static void uart_emul_mock_notify(struct uart_emul_mock_data *data, struct uart_event *ev) {
+    if (data->callback) {
+        data->callback(data->dev, ev, data->user_data);
+    }
+}
+
+static void uart_emul_mock_rx_rdy(struct uart_emul_mock_data *data) {
+    if (data->rx_len == data->rx_reported) {
+        return;
+    }
+
+    struct uart_event ev = {
+        .type = UART_RX_RDY,
+        .data.rx = {.buf = data->rx_buf,
+                    .offset = data->rx_reported,
+                    .len = data->rx_len - data->rx_reported},
+    };
+
+    data->rx_reported = data->rx_len;
+    uart_emul_mock_notify(data, &ev);
+}
+
+static void uart_emul_mock_rx_buf_released(struct uart_emul_mock_data *data, uint8_t *buf) {
+    struct uart_event ev = {.type = UART_RX_BUF_RELEASED, .data.rx_buf = {.buf = buf}};
+
+    uart_emul_mock_notify(data, &ev);
+}
+
+static void uart_emul_mock_rx_disabled(struct uart_emul_mock_data *data) {
+    struct uart_event ev = {.type = UART_RX_DISABLED};
+
+    uart_emul_mock_notify(data, &ev);
+}
+
+// Like a DMA UART, ask for the next buffer as soon as the current one starts being filled.
+static void uart_emul_mock_rx_start(struct uart_emul_mock_data *data, uint8_t *buf, size_t len) {
+    data->rx_buf = buf;
+    data->rx_buf_len = len;
+    data->rx_len = 0;
+    data->rx_reported = 0;
+
+    struct uart_event ev = {.type = UART_RX_BUF_REQUEST};
+
+    uart_emul_mock_notify(data, &ev);
+}
+
+static void uart_emul_mock_rx_buf_full(struct uart_emul_mock_data *data) {
+    uint8_t *full_buf = data->rx_buf;
+    uint8_t *next_buf = data->rx_next_buf;
+    size_t next_buf_len = data->rx_next_buf_len;
+
+    uart_emul_mock_rx_rdy(data);
+
+    data->rx_buf = NULL;
+    data->rx_next_buf = NULL;
+    uart_emul_mock_rx_buf_released(data, full_buf);
+
+    if (!next_buf) {
+        LOG_WRN("No next RX buffer provided, disabling RX");
+        uart_emul_mock_rx_disabled(data);
+        return;
+    }
+
+    uart_emul_mock_rx_start(data, next_buf, next_buf_len);
+}
+
+static void uart_emul_mock_receive(struct uart_emul_mock_data *data, const uint8_t *bytes,
+                                   size_t len) {
+    while (len > 0) {
+        if (!data->rx_buf) {
+            LOG_WRN("RX is disabled, dropping %d mock bytes", len);
+            return;
+        }
+
+        size_t copy_len = MIN(len, data->rx_buf_len - data->rx_len);
+        memcpy(&data->rx_buf[data->rx_len], bytes, copy_len);
+        data->rx_len += copy_len;
+        bytes += copy_len;
+        len -= copy_len;
+
+        if (data->rx_len == data->rx_buf_len) {
+            uart_emul_mock_rx_buf_full(data);
+        }
+    }
+
+    // The line goes idle after each chunk, so whatever is left is reported as an RX timeout.
+    uart_emul_mock_rx_rdy(data);
+}
+
+static void uart_emul_mock_rx_work_cb(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct uart_emul_mock_data *data = CONTAINER_OF(dwork, struct uart_emul_mock_data, rx_work);
+
+    const struct uart_emul_mock_config *cfg = data->dev->config;
+
+    if (data->chunk_index >= cfg->chunks_len) {
+        return;
+    }
+
+    uint32_t len = cfg->chunk_lengths[data->chunk_index++];
+
+    uart_emul_mock_receive(data, &cfg->data[data->data_offset], len);
+    data->data_offset += len;
+
+    if (data->chunk_index < cfg->chunks_len) {
+        k_work_schedule(&data->rx_work, K_MSEC(cfg->event_period));
+    }
+}
+
+static void uart_emul_mock_tx_work_cb(struct k_work *work) {
+    struct uart_emul_mock_data *data = CONTAINER_OF(work, struct uart_emul_mock_data, tx_work);
+
+    struct uart_event ev = {.type = UART_TX_DONE,
+                            .data.tx = {.buf = data->tx_buf, .len = data->tx_len}};
+
+    data->tx_buf = NULL;
+    uart_emul_mock_notify(data, &ev);
+}
+
+static int uart_emul_mock_callback_set(const struct device *dev, uart_callback_t callback,
+                                       void *user_data) {
+    struct uart_emul_mock_data *data = dev->data;
+
+    data->callback = callback;
+    data->user_data = user_data;
+
+    return 0;
+}
+
+// Nothing is listening on the other end, so anything sent is done right away.
+static int uart_emul_mock_tx(const struct device *dev, const uint8_t *buf, size_t len,
+                             int32_t timeout) {
+    struct uart_emul_mock_data *data = dev->data;
+
+    if (data->tx_buf) {
+        return -EBUSY;
+    }
+
+    data->tx_buf = buf;
+    data->tx_len = len;
+    k_work_submit(&data->tx_work);
+
+    return 0;
+}
+
+static int uart_emul_mock_tx_abort(const struct device *dev) { return -EFAULT; }
+
+static int uart_emul_mock_rx_enable(const struct device *dev, uint8_t *buf, size_t len,
+                                    int32_t timeout) {
+    struct uart_emul_mock_data *data = dev->data;
+
+    if (data->rx_buf) {
+        return -EBUSY;
+    }
+
+    uart_emul_mock_rx_start(data, buf, len);
+
+    return 0;
+}
+
+static int uart_emul_mock_rx_buf_rsp(const struct device *dev, uint8_t *buf, size_t len) {
+    struct uart_emul_mock_data *data = dev->data;
+
+    if (!data->rx_buf) {
+        return -EACCES;
+    }
+
+    if (data->rx_next_buf) {
+        return -EBUSY;
+    }
+
+    data->rx_next_buf = buf;
+    data->rx_next_buf_len = len;
+
+    return 0;
+}
+
+static int uart_emul_mock_rx_disable(const struct device *dev) {
+    struct uart_emul_mock_data *data = dev->data;
+
+    if (!data->rx_buf) {
+        return -EFAULT;
+    }
+
+    uint8_t *buf = data->rx_buf;
+    uint8_t *next_buf = data->rx_next_buf;
+
+    uart_emul_mock_rx_rdy(data);
+
+    data->rx_buf = NULL;
+    data->rx_next_buf = NULL;
+    uart_emul_mock_rx_buf_released(data, buf);
+    if (next_buf) {
+        uart_emul_mock_rx_buf_released(data, next_buf);
+    }
+
+    uart_emul_mock_rx_disabled(data);
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_UART_ASYNC_API)
+
+static int uart_emul_mock_poll_in(const struct device *dev, unsigned char *c) { return -1; }
+
+static void uart_emul_mock_poll_out(const struct device *dev, unsigned char c) {}
+
+static const struct uart_driver_api uart_emul_mock_api = {
+    .poll_in = uart_emul_mock_poll_in,
+    .poll_out = uart_emul_mock_poll_out,
+#if IS_ENABLED(CONFIG_UART_ASYNC_API)
+    .callback_set = uart_emul_mock_callback_set,
+    .tx = uart_emul_mock_tx,
+    .tx_abort = uart_emul_mock_tx_abort,
+    .rx_enable = uart_emul_mock_rx_enable,
+    .rx_buf_rsp = uart_emul_mock_rx_buf_rsp,
+    .rx_disable = uart_emul_mock_rx_disable,
+#endif // IS_ENABLED(CONFIG_UART_ASYNC_API)
+};
+
+int uart_emul_mock_init(const struct device *dev) {
+    struct uart_emul_mock_data *drv_data = dev->data;
+    const struct uart_emul_mock_config *drv_cfg = dev->config;
+
+    drv_data->dev = dev;
+
+#if IS_ENABLED(CONFIG_UART_ASYNC_API)
+    k_work_init(&drv_data->tx_work, uart_emul_mock_tx_work_cb);
+    k_work_init_delayable(&drv_data->rx_work, uart_emul_mock_rx_work_cb);
+
+    k_work_schedule(&drv_data->rx_work, K_MSEC(drv_cfg->startup_delay));
+#endif // IS_ENABLED(CONFIG_UART_ASYNC_API)
+
+    return 0;
+}
+
+#define UART_EMUL_MOCK_INST(n)                                                                     \
+    static struct uart_emul_mock_data uart_emul_mock_data_##n = {};                                \
+    static const uint8_t mock_data_##n[] = DT_INST_PROP(n, data);                                  \
+    static const uint32_t mock_chunk_lengths_##n[] = DT_INST_PROP(n, chunk_lengths);               \
+    static const struct uart_emul_mock_config uart_emul_mock_cfg_##n = {                           \
+        .data = mock_data_##n,                                                                     \
+        .chunk_lengths = mock_chunk_lengths_##n,                                                   \
+        .chunks_len = DT_INST_PROP_LEN(n, chunk_lengths),                                          \
+        .startup_delay = DT_INST_PROP(n, event_startup_delay),                                     \
+        .event_period = DT_INST_PROP(n, event_period),                                             \
+    };                                                                                             \
+    DEVICE_DT_INST_DEFINE(n, uart_emul_mock_init, NULL, &uart_emul_mock_data_##n,                  \
+                          &uart_emul_mock_cfg_##n, POST_KERNEL,                                    \
+                          CONFIG_APPLICATION_INIT_PRIORITY, &uart_emul_mock_api);
+
+DT_INST_FOREACH_STATUS_OKAY(UART_EMUL_MOCK_INST)
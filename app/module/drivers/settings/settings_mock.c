@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_settings_mock
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+struct settings_mock_record {
+    const char *key;
+    const uint8_t *value;
+    size_t value_len;
+};
+
+struct settings_mock_config {
+    const struct settings_mock_record *records;
+    size_t records_len;
+    uint16_t reload_after;
+};
+
+struct settings_mock_data {
+    struct k_work_delayable reload_work;
+};
+
+static void settings_mock_reload_work_cb(struct k_work *work) {
+    LOG_DBG("Loading settings again");
+
+    int ret = settings_load();
+    if (ret < 0) {
+        LOG_ERR("Failed to load settings again (%d)", ret);
+    }
+}
+
+int settings_mock_init(const struct device *dev) {
+    struct settings_mock_data *drv_data = dev->data;
+    const struct settings_mock_config *drv_cfg = dev->config;
+
+    // Runs before main() loads the settings, so the records are there to be loaded.
+    int ret = settings_subsys_init();
+    if (ret < 0) {
+        LOG_ERR("Failed to initialize settings (%d)", ret);
+        return ret;
+    }
+
+    for (int i = 0; i < drv_cfg->records_len; i++) {
+        const struct settings_mock_record *record = &drv_cfg->records[i];
+
+        ret = settings_save_one(record->key, record->value, record->value_len);
+        if (ret < 0) {
+            LOG_ERR("Failed to store mock setting %s (%d)", record->key, ret);
+            return ret;
+        }
+    }
+
+    if (drv_cfg->reload_after > 0) {
+        k_work_init_delayable(&drv_data->reload_work, settings_mock_reload_work_cb);
+        k_work_schedule(&drv_data->reload_work, K_MSEC(drv_cfg->reload_after));
+    }
+
+    return 0;
+}
+
+#define SETTINGS_MOCK_VALUE(node)                                                                  \
+    static const uint8_t _CONCAT(settings_mock_value_, DT_DEP_ORD(node))[] = DT_PROP(node, value);
+
+#define SETTINGS_MOCK_RECORD(node)                                                                 \
+    {                                                                                              \
+        .key = DT_PROP(node, key),                                                                 \
+        .value = _CONCAT(settings_mock_value_, DT_DEP_ORD(node)),                                  \
+        .value_len = DT_PROP_LEN(node, value),                                                     \
+    }
+
+#define SETTINGS_MOCK_INST(n)                                                                      \
+    DT_INST_FOREACH_CHILD(n, SETTINGS_MOCK_VALUE)                                                  \
+    static const struct settings_mock_record settings_mock_records_##n[] = {                       \
+        DT_INST_FOREACH_CHILD_SEP(n, SETTINGS_MOCK_RECORD, (, ))};                                 \
+    static struct settings_mock_data settings_mock_data_##n = {};                                  \
+    static const struct settings_mock_config settings_mock_cfg_##n = {                             \
+        .records = settings_mock_records_##n,                                                      \
+        .records_len = ARRAY_SIZE(settings_mock_records_##n),                                      \
+        .reload_after = DT_INST_PROP(n, reload_after),                                             \
+    };                                                                                             \
+    DEVICE_DT_INST_DEFINE(n, settings_mock_init, NULL, &settings_mock_data_##n,                    \
+                          &settings_mock_cfg_##n, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY,   \
+                          NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(SETTINGS_MOCK_INST)
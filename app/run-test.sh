@@ -55,7 +55,13 @@ if [ $? -gt 0 ]; then
     exit 1
 fi
 
-${ZMK_BUILD_DIR}/tests/$testcase/zephyr/zmk.exe |
+# Tests with a settings backend start from erased flash, kept in a file of their own
+exe_args=""
+if grep -q "^CONFIG_FLASH_SIMULATOR=y" ${ZMK_BUILD_DIR}/tests/$testcase/zephyr/.config; then
+    exe_args="--flash=${ZMK_BUILD_DIR}/tests/$testcase/flash.bin --flash_erase"
+fi
+
+${ZMK_BUILD_DIR}/tests/$testcase/zephyr/zmk.exe $exe_args |
     sed -e "s/.*> //" |
     tee ${ZMK_BUILD_DIR}/tests/$testcase/keycode_events_full.log |
     sed -n -f $path/events.patterns >${ZMK_BUILD_DIR}/tests/$testcase/keycode_events.log
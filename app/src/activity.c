@@ -19,6 +19,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/events/sensor_event.h>
 
 #include <zmk/pm.h>
+#include <zmk/timer.h>
 
 #include <zmk/activity.h>
 
@@ -75,7 +76,10 @@ void activity_work_handler(struct k_work *work) {
     int32_t current = k_uptime_get();
     int32_t inactive_time = current - activity_last_uptime;
 #if IS_ENABLED(CONFIG_ZMK_SLEEP)
-    if (inactive_time > MAX_SLEEP_MS && !is_usb_power_present()) {
+    // A pending behavior timeout still has to run, e.g. to release a sticky key, so sleep is put
+    // off until the last deadline has passed.
+    if (inactive_time > MAX_SLEEP_MS && !is_usb_power_present() &&
+        zmk_timer_next_deadline() == ZMK_TIMER_NO_DEADLINE) {
         // Put devices in suspend power mode before sleeping
         set_state(ZMK_ACTIVITY_SLEEP);
 
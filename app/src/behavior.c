@@ -55,6 +55,22 @@ const struct device *z_impl_behavior_get_binding(const char *name) {
     return NULL;
 }
 
+const struct device *zmk_behavior_get_binding_device(const struct zmk_behavior_binding *binding) {
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    if (binding->behavior_device) {
+        return binding->behavior_device;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+
+    return zmk_behavior_get_binding(binding->behavior_dev);
+}
+
+void zmk_behavior_resolve_binding_device(struct zmk_behavior_binding *binding) {
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    binding->behavior_device = zmk_behavior_get_binding(binding->behavior_dev);
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+}
+
 static int invoke_locally(struct zmk_behavior_binding *binding,
                           struct zmk_behavior_binding_event event, bool pressed) {
     if (pressed) {
@@ -66,12 +82,17 @@ static int invoke_locally(struct zmk_behavior_binding *binding,
 
 int zmk_behavior_invoke_binding(const struct zmk_behavior_binding *src_binding,
                                 struct zmk_behavior_binding_event event, bool pressed) {
+    return zmk_behavior_invoke_resolved_binding(
+        src_binding, zmk_behavior_get_binding_device(src_binding), event, pressed);
+}
+
+int zmk_behavior_invoke_resolved_binding(const struct zmk_behavior_binding *src_binding,
+                                         const struct device *behavior,
+                                         struct zmk_behavior_binding_event event, bool pressed) {
     // We want to make a copy of this, since it may be converted from
     // relative to absolute before being invoked
     struct zmk_behavior_binding binding = *src_binding;
 
-    const struct device *behavior = zmk_behavior_get_binding(binding.behavior_dev);
-
     if (!behavior) {
         LOG_WRN("No behavior assigned to %d on layer %d", event.position, event.layer);
         return 1;
@@ -239,7 +260,7 @@ int zmk_behavior_check_params_match_metadata(const struct behavior_parameter_met
 
 int zmk_behavior_validate_binding(const struct zmk_behavior_binding *binding) {
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_METADATA)
-    const struct device *behavior = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *behavior = zmk_behavior_get_binding_device(binding);
 
     if (!behavior) {
         return -ENODEV;
@@ -276,9 +297,29 @@ zmk_behavior_local_id_t zmk_behavior_get_local_id(const char *name) {
 }
 
 const char *zmk_behavior_find_behavior_name_from_local_id(zmk_behavior_local_id_t local_id) {
+    const struct device *dev = zmk_behavior_get_device_from_local_id(local_id);
+
+    return dev ? dev->name : NULL;
+}
+
+zmk_behavior_local_id_t zmk_behavior_get_local_id_for_device(const struct device *dev) {
+    if (!dev) {
+        return UINT16_MAX;
+    }
+
+    STRUCT_SECTION_FOREACH(zmk_behavior_local_id_map, item) {
+        if (item->device == dev && z_device_is_ready(item->device)) {
+            return item->local_id;
+        }
+    }
+
+    return UINT16_MAX;
+}
+
+const struct device *zmk_behavior_get_device_from_local_id(zmk_behavior_local_id_t local_id) {
     STRUCT_SECTION_FOREACH(zmk_behavior_local_id_map, item) {
         if (z_device_is_ready(item->device) && item->local_id == local_id) {
-            return item->device->name;
+            return item->device;
         }
     }
 
@@ -17,6 +17,7 @@
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/keycode_state_changed.h>
+#include <zmk/timer.h>
 #include <zmk/behavior.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -24,7 +25,6 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #if DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
 
 #define ZMK_BHV_HOLD_TAP_MAX_HELD CONFIG_ZMK_BEHAVIOR_HOLD_TAP_MAX_HELD
-#define ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS CONFIG_ZMK_BEHAVIOR_HOLD_TAP_MAX_CAPTURED_EVENTS
 
 // increase if you have keyboard with more keys.
 #define ZMK_BHV_HOLD_TAP_POSITION_NOT_USED 9999
@@ -84,8 +84,8 @@ struct active_hold_tap {
     int64_t timestamp;
     enum status status;
     const struct behavior_hold_tap_config *config;
-    struct k_work_delayable work;
-    bool work_is_cancelled;
+    struct zmk_timer timer;
+    bool timer_is_cancelled;
 
     // initialized to -1, which is to be interpreted as "no other key has been pressed yet"
     int32_t position_of_first_other_key_pressed;
@@ -93,30 +93,15 @@ struct active_hold_tap {
 
 // The undecided hold tap is the hold tap that needs to be decided before
 // other keypress events can be released. While the undecided_hold_tap is
-// not NULL, most events are captured in captured_events.
+// not NULL, most events are captured in the event manager's capture buffer.
 // After the hold_tap is decided, it will stay in the active_hold_taps until
-// its key-up has been processed and the delayed work is cleaned up.
+// its key-up has been processed and the timer is cleaned up.
 struct active_hold_tap *undecided_hold_tap = NULL;
 struct active_hold_tap active_hold_taps[ZMK_BHV_HOLD_TAP_MAX_HELD] = {};
 // We capture most position_state_changed events and some modifiers_state_changed events.
 
-enum captured_event_tag {
-    ET_NONE,
-    ET_POS_CHANGED,
-    ET_CODE_CHANGED,
-};
-
-union captured_event_data {
-    struct zmk_position_state_changed_event position;
-    struct zmk_keycode_state_changed_event keycode;
-};
-
-struct captured_event {
-    enum captured_event_tag tag;
-    union captured_event_data data;
-};
-
-struct captured_event captured_events[ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS] = {};
+BUILD_ASSERT(sizeof(struct zmk_position_state_changed_event) <= ZMK_EVENT_CAPTURE_SLOT_SIZE);
+BUILD_ASSERT(sizeof(struct zmk_keycode_state_changed_event) <= ZMK_EVENT_CAPTURE_SLOT_SIZE);
 
 // Keep track of which key was tapped most recently for the standard, if it is a hold-tap
 // a position, will be given, if not it will just be INT32_MIN
@@ -150,96 +135,46 @@ static bool is_quick_tap(struct active_hold_tap *hold_tap) {
     }
 }
 
-static int capture_event(struct captured_event *data) {
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        if (captured_events[i].tag == ET_NONE) {
-            captured_events[i] = *data;
-            return 0;
-        }
-    }
-    return -ENOMEM;
-}
+const struct zmk_listener zmk_listener_behavior_hold_tap;
 
 static bool have_captured_keydown_event(uint32_t position) {
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        struct captured_event *ev = &captured_events[i];
-        if (ev->tag == ET_NONE) {
-            return false;
-        }
-
-        if (ev->tag != ET_POS_CHANGED) {
-            continue;
-        }
-
-        if (ev->data.position.data.position == position && ev->data.position.data.state) {
+    // Only the events captured for the current undecided hold-tap are considered; events still
+    // waiting to be replayed from a previous hold-tap are not in the captured state.
+    for (zmk_event_t *eh = zmk_event_manager_next_captured(&zmk_listener_behavior_hold_tap, NULL);
+         eh != NULL; eh = zmk_event_manager_next_captured(&zmk_listener_behavior_hold_tap, eh)) {
+        struct zmk_position_state_changed *ev = as_zmk_position_state_changed(eh);
+        if (ev && ev->position == position && ev->state) {
             return true;
         }
     }
     return false;
 }
 
-const struct zmk_listener zmk_listener_behavior_hold_tap;
-
 static void release_captured_events() {
     if (undecided_hold_tap != NULL) {
         return;
     }
 
-    // We use a trick to prevent copying the captured_events array.
-    //
-    // Events for different mod-tap instances are separated by a NULL pointer.
-    //
-    // The first event popped will never be caught by the next active hold-tap
-    // because to start capturing a mod-tap-key-down event must first completely
-    // go through the events queue.
-    //
-    // Example of this release process;
-    // [mt2_down, k1_down, k1_up, mt2_up, null, ...]
-    //  ^
-    // mt2_down position event isn't captured because no hold-tap is active.
-    // mt2_down behavior event is handled, now we have an undecided hold-tap
-    // [null, k1_down, k1_up, mt2_up, null, ...]
-    //        ^
-    // k1_down  is captured by the mt2 mod-tap
-    // !note that searches for find_captured_keydown_event by the mt2 behavior will stop at the
-    // first null encountered [mt1_down, null, k1_up, mt2_up, null, ...]
-    //                  ^
-    // k1_up event is captured by the new hold-tap:
-    // [k1_down, k1_up, null, mt2_up, null, ...]
-    //                        ^
-    // mt2_up event is not captured but causes release of mt2 behavior
-    // [k1_down, k1_up, null, null, null, ...]
-    // now mt2 will start releasing it's own captured positions.
-    for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_CAPTURED_EVENTS; i++) {
-        struct captured_event *captured_event = &captured_events[i];
-        enum captured_event_tag tag = captured_event->tag;
-
-        if (tag == ET_NONE) {
-            return;
+    // The batch to replay is the events captured by the hold-tap that was just decided. Replaying
+    // an event can make another hold-tap undecided, which then captures the rest of the batch
+    // again as it is replayed. Those events keep their place in the capture buffer, so anything
+    // captured later is still replayed after them. Capturing never blocks, so the whole batch is
+    // replayed right away, before the new hold-tap's timer or any later event can be handled.
+    zmk_event_manager_begin_replay(&zmk_listener_behavior_hold_tap);
+
+    zmk_event_t *eh;
+    while ((eh = zmk_event_manager_next_replay(&zmk_listener_behavior_hold_tap)) != NULL) {
+        struct zmk_keycode_state_changed *keycode_ev;
+        struct zmk_position_state_changed *position_ev;
+        if ((keycode_ev = as_zmk_keycode_state_changed(eh)) != NULL) {
+            LOG_DBG("Releasing mods changed event 0x%02X %s", keycode_ev->keycode,
+                    (keycode_ev->state ? "pressed" : "released"));
+        } else if ((position_ev = as_zmk_position_state_changed(eh)) != NULL) {
+            LOG_DBG("Releasing key position event for position %d %s", position_ev->position,
+                    (position_ev->state ? "pressed" : "released"));
         }
 
-        captured_events[i].tag = ET_NONE;
-        if (undecided_hold_tap != NULL) {
-            k_msleep(10);
-        }
-
-        switch (tag) {
-        case ET_CODE_CHANGED:
-            LOG_DBG("Releasing mods changed event 0x%02X %s",
-                    captured_event->data.keycode.data.keycode,
-                    (captured_event->data.keycode.data.state ? "pressed" : "released"));
-            ZMK_EVENT_RAISE_AT(captured_event->data.keycode, behavior_hold_tap);
-            break;
-        case ET_POS_CHANGED:
-            LOG_DBG("Releasing key position event for position %d %s",
-                    captured_event->data.position.data.position,
-                    (captured_event->data.position.data.state ? "pressed" : "released"));
-            ZMK_EVENT_RAISE_AT(captured_event->data.position, behavior_hold_tap);
-            break;
-        default:
-            LOG_ERR("Unhandled captured event type");
-            break;
-        }
+        zmk_event_manager_replay_captured(eh);
     }
 }
 
@@ -277,7 +212,7 @@ static struct active_hold_tap *store_hold_tap(struct zmk_behavior_binding_event
 static void clear_hold_tap(struct active_hold_tap *hold_tap) {
     hold_tap->position = ZMK_BHV_HOLD_TAP_POSITION_NOT_USED;
     hold_tap->status = STATUS_UNDECIDED;
-    hold_tap->work_is_cancelled = false;
+    hold_tap->timer_is_cancelled = false;
 }
 
 static void decide_balanced(struct active_hold_tap *hold_tap, enum decision_moment event) {
@@ -605,7 +540,7 @@ static void update_hold_status_for_retro_tap(uint32_t ignore_position) {
 
 static int on_hold_tap_binding_pressed(struct zmk_behavior_binding *binding,
                                        struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
     const struct behavior_hold_tap_config *cfg = dev->config;
 
     if (undecided_hold_tap != NULL) {
@@ -632,10 +567,9 @@ static int on_hold_tap_binding_pressed(struct zmk_behavior_binding *binding,
 
     decide_hold_tap(hold_tap, HT_KEY_DOWN);
 
-    // if this behavior was queued we have to adjust the timer to only
-    // wait for the remaining time.
-    int32_t tapping_term_ms_left = (hold_tap->timestamp + cfg->tapping_term_ms) - k_uptime_get();
-    k_work_schedule(&hold_tap->work, K_MSEC(tapping_term_ms_left));
+    // if this behavior was queued the deadline is already closer than the tapping term, as it is
+    // counted from the time of the key press.
+    zmk_timer_start_at(&hold_tap->timer, hold_tap->timestamp + cfg->tapping_term_ms);
 
     return ZMK_BEHAVIOR_OPAQUE;
 }
@@ -650,7 +584,7 @@ static int on_hold_tap_binding_released(struct zmk_behavior_binding *binding,
 
     // If these events were queued, the timer event may be queued too late or not at all.
     // We insert a timer event before the TH_KEY_UP event to verify.
-    int work_cancel_result = k_work_cancel_delayable(&hold_tap->work);
+    int timer_cancel_result = zmk_timer_cancel(&hold_tap->timer);
     if (event.timestamp > (hold_tap->timestamp + hold_tap->config->tapping_term_ms)) {
         decide_hold_tap(hold_tap, HT_TIMER_EVENT);
     }
@@ -663,11 +597,11 @@ static int on_hold_tap_binding_released(struct zmk_behavior_binding *binding,
         release_hold_binding(hold_tap);
     }
 
-    if (work_cancel_result == -EINPROGRESS) {
+    if (timer_cancel_result == -EINPROGRESS) {
         // let the timer handler clean up
         // if we'd clear now, the timer may call back for an uninitialized active_hold_tap.
-        LOG_DBG("%d hold-tap timer work in event queue", event.position);
-        hold_tap->work_is_cancelled = true;
+        LOG_DBG("%d hold-tap timer handler running", event.position);
+        hold_tap->timer_is_cancelled = true;
     } else {
         LOG_DBG("%d cleaning up hold-tap", event.position);
         clear_hold_tap(hold_tap);
@@ -776,11 +710,11 @@ static int position_state_changed_listener(const zmk_event_t *eh) {
 
     LOG_DBG("%d capturing %d %s event", undecided_hold_tap->position, ev->position,
             ev->state ? "down" : "up");
-    struct captured_event capture = {
-        .tag = ET_POS_CHANGED,
-        .data = {.position = copy_raised_zmk_position_state_changed(ev)},
-    };
-    capture_event(&capture);
+    if (zmk_event_manager_capture(eh) == NULL) {
+        LOG_ERR("Unable to capture %d %s event", ev->position, ev->state ? "down" : "up");
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
     decide_hold_tap(undecided_hold_tap, ev->state ? HT_OTHER_KEY_DOWN : HT_OTHER_KEY_UP);
     return ZMK_EV_EVENT_CAPTURED;
 }
@@ -813,9 +747,11 @@ static int keycode_state_changed_listener(const zmk_event_t *eh) {
     // if a undecided_hold_tap is active.
     LOG_DBG("%d capturing 0x%02X %s event", undecided_hold_tap->position, ev->keycode,
             ev->state ? "down" : "up");
-    struct captured_event capture = {
-        .tag = ET_CODE_CHANGED, .data = {.keycode = copy_raised_zmk_keycode_state_changed(ev)}};
-    capture_event(&capture);
+    if (zmk_event_manager_capture(eh) == NULL) {
+        LOG_ERR("Unable to capture 0x%02X %s event", ev->keycode, ev->state ? "down" : "up");
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
     return ZMK_EV_EVENT_CAPTURED;
 }
 
@@ -833,11 +769,10 @@ ZMK_SUBSCRIPTION(behavior_hold_tap, zmk_position_state_changed);
 // this should be modifiers_state_changed, but unfrotunately that's not implemented yet.
 ZMK_SUBSCRIPTION(behavior_hold_tap, zmk_keycode_state_changed);
 
-void behavior_hold_tap_timer_work_handler(struct k_work *item) {
-    struct k_work_delayable *d_work = k_work_delayable_from_work(item);
-    struct active_hold_tap *hold_tap = CONTAINER_OF(d_work, struct active_hold_tap, work);
+void behavior_hold_tap_timer_handler(struct zmk_timer *timer) {
+    struct active_hold_tap *hold_tap = CONTAINER_OF(timer, struct active_hold_tap, timer);
 
-    if (hold_tap->work_is_cancelled) {
+    if (hold_tap->timer_is_cancelled) {
         clear_hold_tap(hold_tap);
     } else {
         decide_hold_tap(hold_tap, HT_TIMER_EVENT);
@@ -849,7 +784,7 @@ static int behavior_hold_tap_init(const struct device *dev) {
 
     if (init_first_run) {
         for (int i = 0; i < ZMK_BHV_HOLD_TAP_MAX_HELD; i++) {
-            k_work_init_delayable(&active_hold_taps[i].work, behavior_hold_tap_timer_work_handler);
+            zmk_timer_init(&active_hold_taps[i].timer, behavior_hold_tap_timer_handler);
             active_hold_taps[i].position = ZMK_BHV_HOLD_TAP_POSITION_NOT_USED;
         }
     }
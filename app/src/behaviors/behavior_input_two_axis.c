@@ -13,6 +13,7 @@
 #include <zephyr/sys/util.h> // CLAMP
 
 #include <zmk/behavior.h>
+#include <zmk/timer.h>
 #include <dt-bindings/zmk/pointing.h>
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
@@ -38,7 +39,7 @@ struct movement_state_2d {
 };
 
 struct behavior_input_two_axis_data {
-    struct k_work_delayable tick_work;
+    struct zmk_timer tick_timer;
     const struct device *dev;
 
     struct movement_state_2d state;
@@ -175,10 +176,9 @@ static bool should_be_working(struct behavior_input_two_axis_data *data) {
     return is_non_zero_2d_movement(&data->state);
 }
 
-static void tick_work_cb(struct k_work *work) {
-    struct k_work_delayable *d_work = k_work_delayable_from_work(work);
+static void tick_timer_cb(struct zmk_timer *timer) {
     struct behavior_input_two_axis_data *data =
-        CONTAINER_OF(d_work, struct behavior_input_two_axis_data, tick_work);
+        CONTAINER_OF(timer, struct behavior_input_two_axis_data, tick_timer);
     const struct device *dev = data->dev;
     const struct behavior_input_two_axis_config *cfg = dev->config;
 
@@ -202,7 +202,7 @@ static void tick_work_cb(struct k_work *work) {
     }
 
     if (should_be_working(data)) {
-        k_work_schedule(&data->tick_work, K_MSEC(cfg->trigger_period_ms));
+        zmk_timer_start(&data->tick_timer, cfg->trigger_period_ms);
     }
 }
 
@@ -225,9 +225,12 @@ static void update_work_scheduling(const struct device *dev) {
     set_start_times_for_activity(&data->state);
 
     if (should_be_working(data)) {
-        k_work_schedule(&data->tick_work, K_MSEC(cfg->trigger_period_ms));
+        // Keep the next tick where it is if movement is already running.
+        if (!zmk_timer_is_pending(&data->tick_timer)) {
+            zmk_timer_start(&data->tick_timer, cfg->trigger_period_ms);
+        }
     } else {
-        k_work_cancel_delayable(&data->tick_work);
+        zmk_timer_cancel(&data->tick_timer);
         data->state.y.remainder = 0;
         data->state.x.remainder = 0;
     }
@@ -251,7 +254,7 @@ static int behavior_input_two_axis_init(const struct device *dev) {
     struct behavior_input_two_axis_data *data = dev->data;
 
     data->dev = dev;
-    k_work_init_delayable(&data->tick_work, tick_work_cb);
+    zmk_timer_init(&data->tick_timer, tick_timer_cb);
 
     return 0;
 };
@@ -259,7 +262,7 @@ static int behavior_input_two_axis_init(const struct device *dev) {
 static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
 
-    const struct device *behavior_dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *behavior_dev = zmk_behavior_get_binding_device(binding);
 
     LOG_DBG("position %d keycode 0x%02X", event.position, binding->param1);
 
@@ -272,7 +275,7 @@ static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
 
 static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
                                       struct zmk_behavior_binding_event event) {
-    const struct device *behavior_dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *behavior_dev = zmk_behavior_get_binding_device(binding);
 
     LOG_DBG("position %d keycode 0x%02X", event.position, binding->param1);
 
@@ -63,6 +63,9 @@ enum advertising_type {
 static struct zmk_ble_profile profiles[ZMK_BLE_PROFILE_COUNT];
 static uint8_t active_profile;
 
+// Connection interval of each connected profile, in units of 1.25ms, or 0 if not connected
+static uint16_t profile_conn_intervals[ZMK_BLE_PROFILE_COUNT];
+
 #define DEVICE_NAME CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
@@ -339,6 +342,17 @@ int zmk_ble_prof_disconnect(uint8_t index) {
 
 bt_addr_le_t *zmk_ble_active_profile_addr(void) { return &profiles[active_profile].peer; }
 
+uint32_t zmk_ble_active_profile_conn_interval_us(void) {
+    return profile_conn_intervals[active_profile] * 1250U;
+}
+
+static void update_profile_conn_interval(struct bt_conn *conn, uint16_t interval) {
+    int index = zmk_ble_profile_index(bt_conn_get_dst(conn));
+    if (index >= 0) {
+        profile_conn_intervals[index] = interval;
+    }
+}
+
 struct bt_conn *zmk_ble_active_profile_conn(void) {
     struct bt_conn *conn;
     bt_addr_le_t *addr = zmk_ble_active_profile_addr();
@@ -521,6 +535,8 @@ static void connected(struct bt_conn *conn, uint8_t err) {
 
     LOG_DBG("Connected %s", addr);
 
+    update_profile_conn_interval(conn, info.le.interval);
+
     update_advertising();
 
     if (is_conn_active_profile(conn)) {
@@ -544,6 +560,8 @@ static void disconnected(struct bt_conn *conn, uint8_t reason) {
         return;
     }
 
+    update_profile_conn_interval(conn, 0);
+
     // We need to do this in a work callback, otherwise the advertising update will still see the
     // connection for a profile as active, and not start advertising yet.
     k_work_submit(&update_advertising_work);
@@ -573,6 +591,8 @@ static void le_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t l
     bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
 
     LOG_DBG("%s: interval %d latency %d timeout %d", addr, interval, latency, timeout);
+
+    update_profile_conn_interval(conn, interval);
 }
 
 static struct bt_conn_cb conn_callbacks = {
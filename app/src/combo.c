@@ -21,6 +21,7 @@
 #include <zmk/hid.h>
 #include <zmk/matrix.h>
 #include <zmk/keymap.h>
+#include <zmk/timer.h>
 #include <zmk/virtual_key_position.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -63,7 +64,7 @@ struct active_combo {
     // The keys are removed from this array when they are released.
     // Once this array is empty, the behavior is released.
     uint16_t key_positions_pressed_count;
-    struct zmk_position_state_changed_event key_positions_pressed[MAX_COMBO_KEYS];
+    uint32_t key_positions_pressed[MAX_COMBO_KEYS];
 };
 
 #define PROP_BIT_AT_IDX(n, prop, idx) BIT(DT_PROP_BY_IDX(n, prop, idx))
@@ -107,21 +108,31 @@ static const struct combo_cfg combos[] = {
 // We need at least 4 bytes to avoid alignment issues
 #define BYTES_FOR_COMBOS_MASK DIV_ROUND_UP(COMBO_CHILDREN_COUNT, 32)
 
+BUILD_ASSERT(sizeof(struct zmk_position_state_changed_event) <= ZMK_EVENT_CAPTURE_SLOT_SIZE);
+
 uint8_t pressed_keys_count = 0;
-// set of keys pressed
-struct zmk_position_state_changed_event pressed_keys[MAX_COMBO_KEYS] = {};
+// set of keys pressed, held in the event manager's capture buffer
+zmk_event_t *pressed_keys[MAX_COMBO_KEYS] = {};
 // the set of candidate combos based on the currently pressed_keys
 uint32_t candidates[BYTES_FOR_COMBOS_MASK];
+// the candidates of the current keypress sequence, sorted by timeout, shortest first. Entries
+// that have since been cleared from `candidates` are skipped, so the next deadline is always at
+// the head once those are popped.
+uint16_t candidate_timeouts[COMBO_CHILDREN_COUNT];
+uint16_t candidate_timeouts_head = 0;
+uint16_t candidate_timeouts_len = 0;
 // the last candidate that was completely pressed
 int16_t fully_pressed_combo = INT16_MAX;
 // a lookup dict that maps a key position to all combos on that position
 uint32_t combo_lookup[ZMK_KEYMAP_LEN][BYTES_FOR_COMBOS_MASK] = {};
+// a lookup dict that maps a layer to all combos that are active on that layer
+uint32_t combo_layer_lookup[ZMK_KEYMAP_LAYERS_LEN][BYTES_FOR_COMBOS_MASK] = {};
 // combos that have been activated and still have (some) keys pressed
 // this array is always contiguous from 0.
 struct active_combo active_combos[CONFIG_ZMK_COMBO_MAX_PRESSED_COMBOS] = {};
 uint8_t active_combo_count = 0;
 
-struct k_work_delayable timeout_task;
+struct zmk_timer timeout_task;
 int64_t timeout_task_timeout_at;
 
 // this keeps track of the last non-combo, non-mod key tap
@@ -135,6 +146,18 @@ static void store_last_tapped(int64_t timestamp) {
     }
 }
 
+static inline struct zmk_position_state_changed *pressed_key(int index) {
+    return as_zmk_position_state_changed(pressed_keys[index]);
+}
+
+static bool combo_active_on_layer(const struct combo_cfg *combo, uint8_t layer) {
+    if (!combo->layer_mask) {
+        return true;
+    }
+
+    return combo->layer_mask & BIT(layer);
+}
+
 // Store the combo key pointer in the combos array, one pointer for each key position
 // The combos are sorted shortest-first, then by virtual-key-position.
 static int initialize_combo(size_t index) {
@@ -144,15 +167,71 @@ static int initialize_combo(size_t index) {
         sys_bitfield_set_bit((mem_addr_t)&combo_lookup[new_combo->key_positions[kp]], index);
     }
 
+    for (uint8_t layer = 0; layer < ZMK_KEYMAP_LAYERS_LEN; layer++) {
+        if (combo_active_on_layer(new_combo, layer)) {
+            sys_bitfield_set_bit((mem_addr_t)&combo_layer_lookup[layer], index);
+        }
+    }
+
     return 0;
 }
 
-static bool combo_active_on_layer(const struct combo_cfg *combo, uint8_t layer) {
-    if (!combo->layer_mask) {
-        return true;
+// Find the next combo index at or after `from` that is set in `mask`, or -1 if there is none.
+static int next_combo_in_mask(const uint32_t *mask, int from) {
+    for (int word = from / 32; word < BYTES_FOR_COMBOS_MASK; word++) {
+        uint32_t bits = mask[word];
+        if (word == from / 32) {
+            bits &= ~BIT_MASK(from % 32);
+        }
+
+        if (bits) {
+            return word * 32 + __builtin_ctz(bits);
+        }
     }
 
-    return combo->layer_mask & BIT(layer);
+    return -1;
+}
+
+#define FOR_EACH_COMBO_IN_MASK(mask, i)                                                            \
+    for (int i = next_combo_in_mask(mask, 0); i >= 0; i = next_combo_in_mask(mask, i + 1))
+
+static int count_candidates(void) {
+    int count = 0;
+    for (int i = 0; i < BYTES_FOR_COMBOS_MASK; i++) {
+        count += __builtin_popcount(candidates[i]);
+    }
+
+    return count;
+}
+
+static void add_candidate(int combo_idx) {
+    sys_bitfield_set_bit((mem_addr_t)&candidates, combo_idx);
+
+    int i = candidate_timeouts_len++;
+    for (; i > 0 && combos[candidate_timeouts[i - 1]].timeout_ms > combos[combo_idx].timeout_ms;
+         i--) {
+        candidate_timeouts[i] = candidate_timeouts[i - 1];
+    }
+    candidate_timeouts[i] = combo_idx;
+}
+
+static void clear_candidates(void) {
+    memset(candidates, 0, BYTES_FOR_COMBOS_MASK * sizeof(uint32_t));
+    candidate_timeouts_head = 0;
+    candidate_timeouts_len = 0;
+}
+
+// Returns the remaining candidate with the shortest timeout, or -1 if there are none.
+static int first_candidate_to_time_out(void) {
+    while (candidate_timeouts_head < candidate_timeouts_len &&
+           !sys_bitfield_test_bit((mem_addr_t)&candidates,
+                                  candidate_timeouts[candidate_timeouts_head])) {
+        candidate_timeouts_head++;
+    }
+
+    return candidate_timeouts_head < candidate_timeouts_len
+               ? candidate_timeouts[candidate_timeouts_head]
+               : -1;
 }
 
 static bool is_quick_tap(const struct combo_cfg *combo, int64_t timestamp) {
@@ -163,15 +242,21 @@ static int setup_candidates_for_first_keypress(int32_t position, int64_t timesta
     int number_of_combo_candidates = 0;
     uint8_t highest_active_layer = zmk_keymap_highest_layer_active();
 
-    for (size_t i = 0; i < ARRAY_SIZE(combos); i++) {
-        if (sys_bitfield_test_bit((mem_addr_t)&combo_lookup[position], i)) {
-            const struct combo_cfg *combo = &combos[i];
-            if (combo_active_on_layer(combo, highest_active_layer) &&
-                !is_quick_tap(combo, timestamp)) {
-                sys_bitfield_set_bit((mem_addr_t)&candidates, i);
-                number_of_combo_candidates++;
-            }
-            // LOG_DBG("combo timeout %d %d %d", position, i, candidates[i].timeout_at);
+    clear_candidates();
+    if (highest_active_layer >= ZMK_KEYMAP_LAYERS_LEN) {
+        return 0;
+    }
+
+    uint32_t layer_candidates[BYTES_FOR_COMBOS_MASK];
+    for (int i = 0; i < BYTES_FOR_COMBOS_MASK; i++) {
+        layer_candidates[i] =
+            combo_lookup[position][i] & combo_layer_lookup[highest_active_layer][i];
+    }
+
+    FOR_EACH_COMBO_IN_MASK(layer_candidates, i) {
+        if (!is_quick_tap(&combos[i], timestamp)) {
+            add_candidate(i);
+            number_of_combo_candidates++;
         }
     }
 
@@ -203,17 +288,15 @@ static int filter_candidates(int32_t position) {
 
 static int64_t first_candidate_timeout() {
     if (pressed_keys_count == 0) {
-        return LONG_MAX;
+        return LLONG_MAX;
     }
 
-    int64_t first_timeout = LONG_MAX;
-    for (int i = 0; i < ARRAY_SIZE(combos); i++) {
-        if (sys_bitfield_test_bit((mem_addr_t)&candidates, i)) {
-            first_timeout = MIN(first_timeout, combos[i].timeout_ms);
-        }
+    int first = first_candidate_to_time_out();
+    if (first < 0) {
+        return LLONG_MAX;
     }
 
-    return pressed_keys[0].data.timestamp + first_timeout;
+    return pressed_key(0)->timestamp + combos[first].timeout_ms;
 }
 
 static inline bool candidate_is_completely_pressed(const struct combo_cfg *candidate) {
@@ -230,18 +313,15 @@ static int cleanup();
 static int filter_timed_out_candidates(int64_t timestamp) {
     __ASSERT(pressed_keys_count > 0, "Searching for a candidate timeout with no keys pressed");
 
-    int remaining_candidates = 0;
-    for (int i = 0; i < ARRAY_SIZE(combos); i++) {
-        if (sys_bitfield_test_bit((mem_addr_t)&candidates, i)) {
-
-            if (pressed_keys[0].data.timestamp + combos[i].timeout_ms > timestamp) {
-                remaining_candidates++;
-            } else {
-                sys_bitfield_clear_bit((mem_addr_t)&candidates, i);
-            }
-        }
+    int first;
+    while ((first = first_candidate_to_time_out()) >= 0 &&
+           pressed_key(0)->timestamp + combos[first].timeout_ms <= timestamp) {
+        sys_bitfield_clear_bit((mem_addr_t)&candidates, first);
+        candidate_timeouts_head++;
     }
 
+    int remaining_candidates = count_candidates();
+
     LOG_DBG(
         "after filtering out timed out combo candidates: remaining_candidates=%d timestamp=%lld",
         remaining_candidates, timestamp);
@@ -249,12 +329,17 @@ static int filter_timed_out_candidates(int64_t timestamp) {
     return remaining_candidates;
 }
 
-static int capture_pressed_key(const struct zmk_position_state_changed *ev) {
+static int capture_pressed_key(const zmk_event_t *ev) {
     if (pressed_keys_count == MAX_COMBO_KEYS) {
         return ZMK_EV_EVENT_BUBBLE;
     }
 
-    pressed_keys[pressed_keys_count++] = copy_raised_zmk_position_state_changed(ev);
+    zmk_event_t *captured = zmk_event_manager_capture(ev);
+    if (captured == NULL) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    pressed_keys[pressed_keys_count++] = captured;
     return ZMK_EV_EVENT_CAPTURED;
 }
 
@@ -264,14 +349,16 @@ static int release_pressed_keys() {
     uint8_t count = pressed_keys_count;
     pressed_keys_count = 0;
     for (int i = 0; i < count; i++) {
-        struct zmk_position_state_changed_event *ev = &pressed_keys[i];
+        zmk_event_t *captured = pressed_keys[i];
         if (i == 0) {
-            LOG_DBG("combo: releasing position event %d", ev->data.position);
-            ZMK_EVENT_RELEASE(*ev);
+            LOG_DBG("combo: releasing position event %d",
+                    as_zmk_position_state_changed(captured)->position);
+            zmk_event_manager_release_captured(captured);
         } else {
             // reprocess events (see tests/combo/fully-overlapping-combos-3 for why this is needed)
-            LOG_DBG("combo: reraising position event %d", ev->data.position);
-            ZMK_EVENT_RAISE(*ev);
+            LOG_DBG("combo: reraising position event %d",
+                    as_zmk_position_state_changed(captured)->position);
+            zmk_event_manager_reraise_captured(captured);
         }
     }
 
@@ -310,7 +397,8 @@ static void move_pressed_keys_to_active_combo(struct active_combo *active_combo)
 
     int combo_length = MIN(pressed_keys_count, combos[active_combo->combo_idx].key_position_len);
     for (int i = 0; i < combo_length; i++) {
-        active_combo->key_positions_pressed[i] = pressed_keys[i];
+        active_combo->key_positions_pressed[i] = pressed_key(i)->position;
+        zmk_event_manager_discard_captured(pressed_keys[i]);
     }
     active_combo->key_positions_pressed_count = combo_length;
 
@@ -343,9 +431,9 @@ static void activate_combo(int combo_idx) {
         release_pressed_keys();
         return;
     }
+    int64_t timestamp = pressed_key(0)->timestamp;
     move_pressed_keys_to_active_combo(active_combo);
-    press_combo_behavior(combo_idx, &combos[combo_idx],
-                         active_combo->key_positions_pressed[0].data.timestamp);
+    press_combo_behavior(combo_idx, &combos[combo_idx], timestamp);
 }
 
 static void deactivate_combo(int active_combo_index) {
@@ -371,7 +459,7 @@ static bool release_combo_key(int32_t position, int64_t timestamp) {
             if (key_released) {
                 active_combo->key_positions_pressed[i - 1] = active_combo->key_positions_pressed[i];
                 all_keys_released = false;
-            } else if (active_combo->key_positions_pressed[i].data.position != position) {
+            } else if (active_combo->key_positions_pressed[i] != position) {
                 all_keys_released = false;
             } else { // position matches
                 key_released = true;
@@ -394,8 +482,8 @@ static bool release_combo_key(int32_t position, int64_t timestamp) {
 }
 
 static int cleanup() {
-    k_work_cancel_delayable(&timeout_task);
-    memset(candidates, 0, BYTES_FOR_COMBOS_MASK * sizeof(uint32_t));
+    zmk_timer_cancel(&timeout_task);
+    clear_candidates();
     if (fully_pressed_combo != INT16_MAX) {
         activate_combo(fully_pressed_combo);
         fully_pressed_combo = INT16_MAX;
@@ -410,12 +498,11 @@ static void update_timeout_task() {
     }
     if (first_timeout == LLONG_MAX) {
         timeout_task_timeout_at = 0;
-        k_work_cancel_delayable(&timeout_task);
+        zmk_timer_cancel(&timeout_task);
         return;
     }
-    if (k_work_schedule(&timeout_task, K_MSEC(first_timeout - k_uptime_get())) >= 0) {
-        timeout_task_timeout_at = first_timeout;
-    }
+    zmk_timer_start_at(&timeout_task, first_timeout);
+    timeout_task_timeout_at = first_timeout;
 }
 
 static int position_state_down(const zmk_event_t *ev, struct zmk_position_state_changed *data) {
@@ -431,22 +518,21 @@ static int position_state_down(const zmk_event_t *ev, struct zmk_position_state_
     }
 
     LOG_DBG("combo: capturing position event %d", data->position);
-    int ret = capture_pressed_key(data);
+    int ret = capture_pressed_key(ev);
     update_timeout_task();
 
     if (num_candidates) {
-        for (int i = 0; i < ARRAY_SIZE(combos); i++) {
-            if (sys_bitfield_test_bit((mem_addr_t)&candidates, i)) {
-                const struct combo_cfg *candidate_combo = &combos[i];
-                if (candidate_is_completely_pressed(candidate_combo)) {
-                    fully_pressed_combo = i;
-                    if (num_candidates == 1) {
-                        cleanup();
-                    }
+        // Combos are sorted shortest first, so only the first candidate can be completely pressed
+        int i = next_combo_in_mask(candidates, 0);
+        if (i >= 0) {
+            if (candidate_is_completely_pressed(&combos[i])) {
+                fully_pressed_combo = i;
+                if (num_candidates == 1) {
+                    cleanup();
                 }
-
-                return ret;
             }
+
+            return ret;
         }
     } else {
         cleanup();
@@ -464,15 +550,13 @@ static int position_state_up(const zmk_event_t *ev, struct zmk_position_state_ch
     if (released_keys > 1) {
         // The second and further key down events are re-raised. To preserve
         // correct order for e.g. hold-taps, reraise the key up event too.
-        struct zmk_position_state_changed_event dupe_ev =
-            copy_raised_zmk_position_state_changed(data);
-        ZMK_EVENT_RAISE(dupe_ev);
+        zmk_event_manager_reraise(ev);
         return ZMK_EV_EVENT_CAPTURED;
     }
     return ZMK_EV_EVENT_BUBBLE;
 }
 
-static void combo_timeout_handler(struct k_work *item) {
+static void combo_timeout_handler(struct zmk_timer *timer) {
     if (timeout_task_timeout_at == 0 || k_uptime_get() < timeout_task_timeout_at) {
         // timer was cancelled or rescheduled.
         return;
@@ -525,7 +609,7 @@ static int combo_init(void) {
         active_combos[i].combo_idx = UINT16_MAX;
     }
 
-    k_work_init_delayable(&timeout_task, combo_timeout_handler);
+    zmk_timer_init(&timeout_task, combo_timeout_handler);
     LOG_WRN("Have %d combos!", ARRAY_SIZE(combos));
     for (int i = 0; i < ARRAY_SIZE(combos); i++) {
         initialize_combo(i);
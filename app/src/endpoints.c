@@ -8,6 +8,7 @@
 #include <zephyr/settings/settings.h>
 
 #include <stdio.h>
+#include <string.h>
 
 #include <zmk/ble.h>
 #include <zmk/endpoints.h>
@@ -118,7 +119,7 @@ int zmk_endpoints_toggle_transport(void) {
 
 struct zmk_endpoint_instance zmk_endpoints_selected(void) { return current_instance; }
 
-static int send_keyboard_report(void) {
+static int send_keyboard_report_to_current(void) {
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
@@ -152,7 +153,7 @@ static int send_keyboard_report(void) {
     return -ENOTSUP;
 }
 
-static int send_consumer_report(void) {
+static int send_consumer_report_to_current(void) {
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
@@ -186,6 +187,117 @@ static int send_consumer_report(void) {
     return -ENOTSUP;
 }
 
+#if !IS_ENABLED(CONFIG_ZMK_ENDPOINTS_SEND_DUPLICATE_REPORTS)
+
+/*
+ * Copy of the last report body successfully sent to each endpoint instance. A report is only sent
+ * if it differs from what the current endpoint last received, so toggling a key on and off again
+ * before the report goes out, or re-raising the same state after an endpoint switch, costs nothing.
+ * The HID dirty flag is used as a fast path when the report is unchanged since the last send to
+ * the same endpoint.
+ */
+struct last_sent_reports {
+    struct zmk_hid_keyboard_report_body keyboard;
+    struct zmk_hid_consumer_report_body consumer;
+    uint8_t valid;
+};
+
+static struct last_sent_reports last_sent[ZMK_ENDPOINT_COUNT];
+static int last_sent_index[2] = {-1, -1};
+
+#define LAST_SENT_KEYBOARD BIT(0)
+#define LAST_SENT_CONSUMER BIT(1)
+
+static bool report_already_sent(uint8_t report_id, uint8_t flag, const void *last,
+                                const void *body, size_t len) {
+    int index = zmk_endpoint_instance_to_index(current_instance);
+    int *sent_index = &last_sent_index[flag == LAST_SENT_CONSUMER];
+
+    if (!(last_sent[index].valid & flag)) {
+        return false;
+    }
+
+    if (!zmk_hid_report_is_dirty(report_id) && *sent_index == index) {
+        return true;
+    }
+
+    return memcmp(last, body, len) == 0;
+}
+
+static void report_sent(uint8_t report_id, uint8_t flag, void *last, const void *body,
+                        size_t len) {
+    int index = zmk_endpoint_instance_to_index(current_instance);
+
+    memcpy(last, body, len);
+    last_sent[index].valid |= flag;
+    last_sent_index[flag == LAST_SENT_CONSUMER] = index;
+    zmk_hid_report_clear_dirty(report_id);
+}
+
+static void invalidate_last_sent(int index) { last_sent[index].valid = 0; }
+
+static int send_keyboard_report(void) {
+    struct zmk_hid_keyboard_report_body *body = &zmk_hid_get_keyboard_report()->body;
+    struct zmk_hid_keyboard_report_body *last =
+        &last_sent[zmk_endpoint_instance_to_index(current_instance)].keyboard;
+
+    if (report_already_sent(ZMK_HID_REPORT_ID_KEYBOARD, LAST_SENT_KEYBOARD, last, body,
+                            sizeof(*body))) {
+        LOG_DBG("Keyboard report unchanged, not sending it again");
+        return 0;
+    }
+
+    int err = send_keyboard_report_to_current();
+    if (!err) {
+        report_sent(ZMK_HID_REPORT_ID_KEYBOARD, LAST_SENT_KEYBOARD, last, body, sizeof(*body));
+    }
+
+    return err;
+}
+
+static int send_consumer_report(void) {
+    struct zmk_hid_consumer_report_body *body = &zmk_hid_get_consumer_report()->body;
+    struct zmk_hid_consumer_report_body *last =
+        &last_sent[zmk_endpoint_instance_to_index(current_instance)].consumer;
+
+    if (report_already_sent(ZMK_HID_REPORT_ID_CONSUMER, LAST_SENT_CONSUMER, last, body,
+                            sizeof(*body))) {
+        LOG_DBG("Consumer report unchanged, not sending it again");
+        return 0;
+    }
+
+    int err = send_consumer_report_to_current();
+    if (!err) {
+        report_sent(ZMK_HID_REPORT_ID_CONSUMER, LAST_SENT_CONSUMER, last, body, sizeof(*body));
+    }
+
+    return err;
+}
+
+#else
+
+static void invalidate_last_sent(int index) {}
+
+static int send_keyboard_report(void) {
+    int err = send_keyboard_report_to_current();
+    if (!err) {
+        zmk_hid_report_clear_dirty(ZMK_HID_REPORT_ID_KEYBOARD);
+    }
+
+    return err;
+}
+
+static int send_consumer_report(void) {
+    int err = send_consumer_report_to_current();
+    if (!err) {
+        zmk_hid_report_clear_dirty(ZMK_HID_REPORT_ID_CONSUMER);
+    }
+
+    return err;
+}
+
+#endif // !IS_ENABLED(CONFIG_ZMK_ENDPOINTS_SEND_DUPLICATE_REPORTS)
+
 int zmk_endpoints_send_report(uint16_t usage_page) {
 
     LOG_DBG("usage page 0x%02X", usage_page);
@@ -359,6 +471,10 @@ static void update_current_endpoint(void) {
 
 static int endpoint_listener(const zmk_event_t *eh) {
     update_current_endpoint();
+
+    // The host on the other end may have reset its view of our reports, so make sure the next
+    // report goes out even if it matches the last one sent.
+    invalidate_last_sent(zmk_endpoint_instance_to_index(current_instance));
     return 0;
 }
 
@@ -4,7 +4,10 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <string.h>
+
 #include <zephyr/kernel.h>
+#include <zephyr/init.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -17,16 +20,19 @@ extern struct zmk_event_type *__event_type_end[];
 extern struct zmk_event_subscription __event_subscriptions_start[];
 extern struct zmk_event_subscription __event_subscriptions_end[];
 
+static inline const struct zmk_listener *
+listener_at(const struct zmk_event_listener_range *range, uint8_t index) {
+    struct zmk_event_listener_slot *slot;
+    STRUCT_SECTION_GET(zmk_event_listener_slot, range->start + index, &slot);
+    return slot->listener;
+}
+
 int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index) {
     int ret = 0;
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = start_index; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
-        if (ev_sub->event_type != event->event) {
-            continue;
-        }
+    const struct zmk_event_listener_range *range = event->event->listeners;
+    for (int i = start_index; i < range->len; i++) {
         event->last_listener_index = i;
-        ret = ev_sub->listener->callback(event);
+        ret = listener_at(range, i)->callback(event);
         switch (ret) {
         case ZMK_EV_EVENT_BUBBLE:
             continue;
@@ -45,38 +51,267 @@ int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index) {
     return 0;
 }
 
-int zmk_event_manager_raise(zmk_event_t *event) { return zmk_event_manager_handle_from(event, 0); }
+static int find_listener_index(const zmk_event_t *event, const struct zmk_listener *listener) {
+    const struct zmk_event_listener_range *range = event->event->listeners;
 
-int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener) {
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = 0; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
+    // Events are almost always re-raised by the listener that captured them, in which case the
+    // index of that listener is still recorded on the event.
+    if (event->last_listener_index < range->len &&
+        listener_at(range, event->last_listener_index) == listener) {
+        return event->last_listener_index;
+    }
 
-        if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
-            return zmk_event_manager_handle_from(event, i + 1);
+    for (int i = 0; i < range->len; i++) {
+        if (listener_at(range, i) == listener) {
+            return i;
         }
     }
 
-    LOG_WRN("Unable to find where to raise this after event");
-
     return -EINVAL;
 }
 
-int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener) {
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = 0; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
+int zmk_event_manager_raise(zmk_event_t *event) { return zmk_event_manager_handle_from(event, 0); }
 
-        if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
-            return zmk_event_manager_handle_from(event, i);
-        }
+int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener) {
+    int index = find_listener_index(event, listener);
+    if (index < 0) {
+        LOG_WRN("Unable to find where to raise this after event");
+        return index;
     }
 
-    LOG_WRN("Unable to find where to raise this event");
+    return zmk_event_manager_handle_from(event, index + 1);
+}
 
-    return -EINVAL;
+int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener) {
+    int index = find_listener_index(event, listener);
+    if (index < 0) {
+        LOG_WRN("Unable to find where to raise this event");
+        return index;
+    }
+
+    return zmk_event_manager_handle_from(event, index);
 }
 
 int zmk_event_manager_release(zmk_event_t *event) {
     return zmk_event_manager_handle_from(event, event->last_listener_index + 1);
 }
+
+int zmk_event_manager_continue(const zmk_event_t *event) {
+    // The event manager owns the dispatch state in the header of events being raised.
+    zmk_event_t *ev = (zmk_event_t *)event;
+    return zmk_event_manager_handle_from(ev, ev->last_listener_index + 1);
+}
+
+int zmk_event_manager_reraise(const zmk_event_t *event) {
+    return zmk_event_manager_handle_from((zmk_event_t *)event, 0);
+}
+
+enum capture_slot_state {
+    CAPTURE_SLOT_FREE,
+    CAPTURE_SLOT_CAPTURED,
+    CAPTURE_SLOT_REPLAY_PENDING,
+    CAPTURE_SLOT_DISPATCHING,
+};
+
+struct capture_slot {
+    union {
+        zmk_event_t header;
+        uint8_t data[ZMK_EVENT_CAPTURE_SLOT_SIZE];
+    } __aligned(8) event;
+    uint8_t state;
+    // Bumped on every allocation so a dispatch can tell whether its slot was reused meanwhile.
+    uint8_t generation;
+};
+
+// Slots in use are always within [capture_head, capture_head + capture_count), in capture order.
+static struct capture_slot capture_slots[CONFIG_ZMK_EVENT_CAPTURE_BUFFER_SIZE];
+static uint16_t capture_head;
+static uint16_t capture_count;
+
+static struct capture_slot *capture_slot_for(const zmk_event_t *event) {
+    if ((const void *)event < (const void *)capture_slots ||
+        (const void *)event >= (const void *)&capture_slots[ARRAY_SIZE(capture_slots)]) {
+        return NULL;
+    }
+
+    return CONTAINER_OF(event, struct capture_slot, event.header);
+}
+
+static struct capture_slot *capture_slot_at(uint16_t offset) {
+    return &capture_slots[(capture_head + offset) % ARRAY_SIZE(capture_slots)];
+}
+
+static void free_capture_slot(struct capture_slot *slot) {
+    slot->state = CAPTURE_SLOT_FREE;
+
+    while (capture_count > 0 && capture_slot_at(0)->state == CAPTURE_SLOT_FREE) {
+        capture_head = (capture_head + 1) % ARRAY_SIZE(capture_slots);
+        capture_count--;
+    }
+}
+
+static bool captured_by(const struct capture_slot *slot, const struct zmk_listener *listener) {
+    const zmk_event_t *event = &slot->event.header;
+    return listener_at(event->event->listeners, event->last_listener_index) == listener;
+}
+
+zmk_event_t *zmk_event_manager_capture(const zmk_event_t *event) {
+    struct capture_slot *slot = capture_slot_for(event);
+
+    if (slot) {
+        // Captured again while being dispatched from the ring, keep it in its slot and position.
+        slot->state = CAPTURE_SLOT_CAPTURED;
+        return &slot->event.header;
+    }
+
+    if (event->event->size > sizeof(slot->event)) {
+        LOG_ERR("Unable to capture %s event of size %zu", event->event->name, event->event->size);
+        return NULL;
+    }
+
+    if (capture_count == ARRAY_SIZE(capture_slots)) {
+        LOG_WRN("Event capture buffer is full, increase CONFIG_ZMK_EVENT_CAPTURE_BUFFER_SIZE");
+        return NULL;
+    }
+
+    slot = capture_slot_at(capture_count++);
+    memcpy(slot->event.data, event, event->event->size);
+    slot->state = CAPTURE_SLOT_CAPTURED;
+    slot->generation++;
+
+    return &slot->event.header;
+}
+
+static int dispatch_captured(struct capture_slot *slot, uint8_t start_index) {
+    uint8_t generation = slot->generation;
+
+    slot->state = CAPTURE_SLOT_DISPATCHING;
+    int ret = zmk_event_manager_handle_from(&slot->event.header, start_index);
+
+    // Free the slot unless a listener captured the event again, or it was already freed and
+    // reused by a nested dispatch.
+    if (slot->generation == generation && slot->state == CAPTURE_SLOT_DISPATCHING) {
+        free_capture_slot(slot);
+    }
+
+    return ret;
+}
+
+int zmk_event_manager_release_captured(zmk_event_t *captured) {
+    struct capture_slot *slot = capture_slot_for(captured);
+    if (!slot) {
+        return -EINVAL;
+    }
+
+    return dispatch_captured(slot, captured->last_listener_index + 1);
+}
+
+int zmk_event_manager_replay_captured(zmk_event_t *captured) {
+    struct capture_slot *slot = capture_slot_for(captured);
+    if (!slot) {
+        return -EINVAL;
+    }
+
+    return dispatch_captured(slot, captured->last_listener_index);
+}
+
+int zmk_event_manager_reraise_captured(zmk_event_t *captured) {
+    struct capture_slot *slot = capture_slot_for(captured);
+    if (!slot) {
+        return -EINVAL;
+    }
+
+    return dispatch_captured(slot, 0);
+}
+
+void zmk_event_manager_discard_captured(zmk_event_t *captured) {
+    struct capture_slot *slot = capture_slot_for(captured);
+    if (slot) {
+        free_capture_slot(slot);
+    }
+}
+
+static zmk_event_t *next_in_state(const struct zmk_listener *listener, const zmk_event_t *prev,
+                                  enum capture_slot_state state) {
+    uint16_t offset = 0;
+
+    if (prev) {
+        struct capture_slot *prev_slot = capture_slot_for(prev);
+        if (!prev_slot) {
+            return NULL;
+        }
+
+        offset = (prev_slot - capture_slots + ARRAY_SIZE(capture_slots) - capture_head) %
+                     ARRAY_SIZE(capture_slots) +
+                 1;
+    }
+
+    for (; offset < capture_count; offset++) {
+        struct capture_slot *slot = capture_slot_at(offset);
+        if (slot->state == state && captured_by(slot, listener)) {
+            return &slot->event.header;
+        }
+    }
+
+    return NULL;
+}
+
+zmk_event_t *zmk_event_manager_next_captured(const struct zmk_listener *listener,
+                                             const zmk_event_t *prev) {
+    return next_in_state(listener, prev, CAPTURE_SLOT_CAPTURED);
+}
+
+void zmk_event_manager_begin_replay(const struct zmk_listener *listener) {
+    for (uint16_t offset = 0; offset < capture_count; offset++) {
+        struct capture_slot *slot = capture_slot_at(offset);
+        if (slot->state == CAPTURE_SLOT_CAPTURED && captured_by(slot, listener)) {
+            slot->state = CAPTURE_SLOT_REPLAY_PENDING;
+        }
+    }
+}
+
+zmk_event_t *zmk_event_manager_next_replay(const struct zmk_listener *listener) {
+    return next_in_state(listener, NULL, CAPTURE_SLOT_REPLAY_PENDING);
+}
+
+static int event_manager_init(void) {
+    size_t len = __event_subscriptions_end - __event_subscriptions_start;
+    uint16_t next_slot = 0;
+
+    if (len > UINT16_MAX) {
+        LOG_ERR("Too many event subscriptions (%d)", len);
+        return -EOVERFLOW;
+    }
+
+    // Group the listeners by event type, keeping the link order of the subscriptions so that
+    // listener priority is unchanged.
+    for (struct zmk_event_type **type = __event_type_start; type < __event_type_end; type++) {
+        struct zmk_event_listener_range *range = (*type)->listeners;
+        range->start = next_slot;
+        range->len = 0;
+
+        for (int i = 0; i < len; i++) {
+            struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
+            if (ev_sub->event_type != *type) {
+                continue;
+            }
+
+            struct zmk_event_listener_slot *slot;
+            STRUCT_SECTION_GET(zmk_event_listener_slot, next_slot++, &slot);
+            slot->listener = ev_sub->listener;
+            range->len++;
+        }
+
+        // Events track the listener they're at in a uint8_t.
+        if (range->len > UINT8_MAX) {
+            LOG_ERR("Too many listeners (%d) for event %s", range->len, (*type)->name);
+            return -EOVERFLOW;
+        }
+
+        LOG_DBG("Event %s has %d listeners", (*type)->name, range->len);
+    }
+
+    return 0;
+}
+
+SYS_INIT(event_manager_init, PRE_KERNEL_1, 0);
@@ -21,7 +21,6 @@ static struct zmk_hid_consumer_report consumer_report = {.report_id = ZMK_HID_RE
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
 
 static zmk_hid_boot_report_t boot_report = {.modifiers = 0, ._reserved = 0, .keys = {0}};
-static uint8_t keys_held = 0;
 
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
@@ -40,9 +39,22 @@ static zmk_mod_flags_t explicit_modifiers = 0;
 static zmk_mod_flags_t implicit_modifiers = 0;
 static zmk_mod_flags_t masked_modifiers = 0;
 
+// Reports that changed since they were last sent, as a bitmask of report IDs
+static uint8_t dirty_reports = 0;
+
+#define MARK_DIRTY(report_id) WRITE_BIT(dirty_reports, report_id, true)
+
+bool zmk_hid_report_is_dirty(uint8_t report_id) { return dirty_reports & BIT(report_id); }
+
+void zmk_hid_report_clear_dirty(uint8_t report_id) { WRITE_BIT(dirty_reports, report_id, false); }
+
 #define SET_MODIFIERS(mods)                                                                        \
     {                                                                                              \
-        keyboard_report.body.modifiers = (mods & ~masked_modifiers) | implicit_modifiers;          \
+        zmk_mod_flags_t new_mods = (mods & ~masked_modifiers) | implicit_modifiers;                \
+        if (keyboard_report.body.modifiers != new_mods) {                                          \
+            keyboard_report.body.modifiers = new_mods;                                             \
+            MARK_DIRTY(ZMK_HID_REPORT_ID_KEYBOARD);                                                \
+        }                                                                                          \
         LOG_DBG("Modifiers set to 0x%02X", keyboard_report.body.modifiers);                        \
     }
 
@@ -113,79 +125,109 @@ static zmk_hid_boot_report_t *boot_report_rollover(uint8_t modifiers) {
 
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
+/*
+ * Held keys are tracked in a bitmap, which for NKRO is the report itself, so checking a usage is
+ * a single bit test. Reports that list keys in fixed slots (the HKRO report and the boot report)
+ * are updated on every transition instead of being rebuilt from the bitmap: a press takes the
+ * lowest free slot, and a release frees the slot holding its usage. A key pressed while all slots
+ * are taken is moved into the first slot that frees up.
+ */
+struct key_slots {
+    uint8_t *keys;
+    uint8_t len;
+    uint8_t count;
+    uint32_t used;
+};
+
 #if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_NKRO)
 
-#define TOGGLE_KEYBOARD(code, val) WRITE_BIT(keyboard_report.body.keys[code / 8], code % 8, val)
+#define HELD_USAGES keyboard_report.body.keys
 
-#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-zmk_hid_boot_report_t *zmk_hid_get_boot_report(void) {
-    if (keys_held > HID_BOOT_KEY_LEN) {
-        return boot_report_rollover(keyboard_report.body.modifiers);
-    }
+#elif IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO)
 
-    boot_report.modifiers = keyboard_report.body.modifiers;
-    memset(&boot_report.keys, 0, HID_BOOT_KEY_LEN);
-    int ix = 0;
-    uint8_t base_code = 0;
-    for (int i = 0; i < sizeof(keyboard_report.body.keys); ++i) {
-        if (ix == keys_held) {
-            break;
-        }
-        if (!keyboard_report.body.keys[i]) {
-            continue;
-        }
-        base_code = i * 8;
-        for (int j = 0; j < 8; ++j) {
-            if (keyboard_report.body.keys[i] & BIT(j)) {
-                boot_report.keys[ix++] = base_code + j;
-            }
-        }
-    }
-    return &boot_report;
-}
+BUILD_ASSERT(CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE <= 32,
+             "HKRO reports are limited to 32 keys by the slot bitmask");
+
+static uint8_t held_usages[DIV_ROUND_UP(ZMK_HID_KEYBOARD_MAX_USAGE + 1, 8)];
+
+#define HELD_USAGES held_usages
+
+static struct key_slots report_slots = {.keys = keyboard_report.body.keys,
+                                        .len = CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE};
+
+#else
+#error "A proper HID report type must be selected"
 #endif
 
-static inline int select_keyboard_usage(zmk_key_t usage) {
-    if (usage > ZMK_HID_KEYBOARD_NKRO_MAX_USAGE) {
-        return -EINVAL;
-    }
-    TOGGLE_KEYBOARD(usage, 1);
-#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-    ++keys_held;
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT) &&                                                             \
+    !(IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO) &&                                               \
+      CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE == HID_BOOT_KEY_LEN)
+
+// Unless the HKRO report can be used as is, the boot report keeps its own slots
+#define HID_BOOT_SLOTS 1
+
+static uint8_t boot_keys[HID_BOOT_KEY_LEN];
+static struct key_slots boot_slots = {.keys = boot_keys, .len = HID_BOOT_KEY_LEN};
+
 #endif
-    return 0;
-}
 
-static inline int deselect_keyboard_usage(zmk_key_t usage) {
-    if (usage > ZMK_HID_KEYBOARD_NKRO_MAX_USAGE) {
-        return -EINVAL;
+static uint8_t keys_held = 0;
+
+#define IS_HELD(usage) (HELD_USAGES[(usage) / 8] & BIT((usage) % 8))
+
+#if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO) || defined(HID_BOOT_SLOTS)
+
+static int key_slots_add(struct key_slots *slots, uint8_t usage) {
+    uint32_t free = ~slots->used & (uint32_t)BIT64_MASK(slots->len);
+    if (!free) {
+        return -ENOMEM;
     }
-    TOGGLE_KEYBOARD(usage, 0);
-#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-    --keys_held;
-#endif
-    return 0;
+
+    int idx = __builtin_ctz(free);
+    slots->keys[idx] = usage;
+    slots->used |= BIT(idx);
+    slots->count++;
+
+    LOG_DBG("Usage 0x%02X added to slot %d", usage, idx);
+    return idx;
 }
 
-static inline bool check_keyboard_usage(zmk_key_t usage) {
-    if (usage > ZMK_HID_KEYBOARD_NKRO_MAX_USAGE) {
-        return false;
+static int key_slots_remove(struct key_slots *slots, uint8_t usage) {
+    uint8_t *key = memchr(slots->keys, usage, slots->len);
+    if (!key) {
+        return -ENOENT;
     }
-    return keyboard_report.body.keys[usage / 8] & (1 << (usage % 8));
+
+    int idx = key - slots->keys;
+    *key = 0;
+    slots->used &= ~BIT(idx);
+    slots->count--;
+
+    LOG_DBG("Usage 0x%02X removed from slot %d", usage, idx);
+    return idx;
 }
 
-#elif IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO)
+// Move a held key that didn't fit into the slots into a slot that was just freed.
+static void key_slots_fill(struct key_slots *slots) {
+    if (slots->count >= keys_held) {
+        return;
+    }
 
-#define TOGGLE_KEYBOARD(match, val)                                                                \
-    for (int idx = 0; idx < CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE; idx++) {                          \
-        if (keyboard_report.body.keys[idx] != match) {                                             \
-            continue;                                                                              \
-        }                                                                                          \
-        keyboard_report.body.keys[idx] = val;                                                      \
-        if (val) {                                                                                 \
-            break;                                                                                 \
-        }                                                                                          \
+    for (int usage = 1; usage < sizeof(HELD_USAGES) * 8; usage++) {
+        if (IS_HELD(usage) && !memchr(slots->keys, usage, slots->len)) {
+            key_slots_add(slots, usage);
+            return;
+        }
     }
+}
+
+static void key_slots_clear(struct key_slots *slots) {
+    memset(slots->keys, 0, slots->len);
+    slots->used = 0;
+    slots->count = 0;
+}
+
+#endif /* IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO) || defined(HID_BOOT_SLOTS) */
 
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
 zmk_hid_boot_report_t *zmk_hid_get_boot_report(void) {
@@ -193,61 +235,74 @@ zmk_hid_boot_report_t *zmk_hid_get_boot_report(void) {
         return boot_report_rollover(keyboard_report.body.modifiers);
     }
 
-#if CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE != HID_BOOT_KEY_LEN
-    // Form a boot report from a report of different size.
-
+#if defined(HID_BOOT_SLOTS)
     boot_report.modifiers = keyboard_report.body.modifiers;
-
-    int out = 0;
-    for (int i = 0; i < CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE; i++) {
-        uint8_t key = keyboard_report.body.keys[i];
-        if (key) {
-            boot_report.keys[out++] = key;
-            if (out == keys_held) {
-                break;
-            }
-        }
-    }
-
-    while (out < HID_BOOT_KEY_LEN) {
-        boot_report.keys[out++] = 0;
-    }
+    memcpy(boot_report.keys, boot_keys, sizeof(boot_keys));
 
     return &boot_report;
 #else
     return &keyboard_report.body;
-#endif /* CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE != HID_BOOT_KEY_LEN */
+#endif /* defined(HID_BOOT_SLOTS) */
 }
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
-static inline int select_keyboard_usage(zmk_key_t usage) {
-    TOGGLE_KEYBOARD(0U, usage);
-#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-    ++keys_held;
+static int select_keyboard_usage(zmk_key_t usage) {
+    if (usage == 0 || usage > ZMK_HID_KEYBOARD_MAX_USAGE) {
+        return -EINVAL;
+    }
+
+    if (IS_HELD(usage)) {
+        return 0;
+    }
+
+    WRITE_BIT(HELD_USAGES[usage / 8], usage % 8, true);
+    keys_held++;
+
+#if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO)
+    key_slots_add(&report_slots, usage);
 #endif
+#if defined(HID_BOOT_SLOTS)
+    key_slots_add(&boot_slots, usage);
+#endif
+
+    MARK_DIRTY(ZMK_HID_REPORT_ID_KEYBOARD);
     return 0;
 }
 
-static inline int deselect_keyboard_usage(zmk_key_t usage) {
-    TOGGLE_KEYBOARD(usage, 0U);
-#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
-    --keys_held;
+static int deselect_keyboard_usage(zmk_key_t usage) {
+    if (usage == 0 || usage > ZMK_HID_KEYBOARD_MAX_USAGE) {
+        return -EINVAL;
+    }
+
+    if (!IS_HELD(usage)) {
+        return 0;
+    }
+
+    WRITE_BIT(HELD_USAGES[usage / 8], usage % 8, false);
+    keys_held--;
+
+#if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO)
+    if (key_slots_remove(&report_slots, usage) >= 0) {
+        key_slots_fill(&report_slots);
+    }
 #endif
+#if defined(HID_BOOT_SLOTS)
+    if (key_slots_remove(&boot_slots, usage) >= 0) {
+        key_slots_fill(&boot_slots);
+    }
+#endif
+
+    MARK_DIRTY(ZMK_HID_REPORT_ID_KEYBOARD);
     return 0;
 }
 
-static inline int check_keyboard_usage(zmk_key_t usage) {
-    for (int idx = 0; idx < CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE; idx++) {
-        if (keyboard_report.body.keys[idx] == usage) {
-            return true;
-        }
+static inline bool check_keyboard_usage(zmk_key_t usage) {
+    if (usage > ZMK_HID_KEYBOARD_MAX_USAGE) {
+        return false;
     }
-    return false;
-}
 
-#else
-#error "A proper HID report type must be selected"
-#endif
+    return IS_HELD(usage);
+}
 
 #define TOGGLE_CONSUMER(match, val)                                                                \
     if (val > ZMK_HID_CONSUMER_MAX_USAGE) {                                                        \
@@ -316,20 +371,32 @@ bool zmk_hid_keyboard_is_pressed(zmk_key_t code) {
 
 void zmk_hid_keyboard_clear(void) {
     memset(&keyboard_report.body, 0, sizeof(keyboard_report.body));
+#if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_HKRO)
+    memset(held_usages, 0, sizeof(held_usages));
+    key_slots_clear(&report_slots);
+#endif
+#if defined(HID_BOOT_SLOTS)
+    key_slots_clear(&boot_slots);
+#endif
+    keys_held = 0;
+    MARK_DIRTY(ZMK_HID_REPORT_ID_KEYBOARD);
 }
 
 int zmk_hid_consumer_press(zmk_key_t code) {
     TOGGLE_CONSUMER(0U, code);
+    MARK_DIRTY(ZMK_HID_REPORT_ID_CONSUMER);
     return 0;
 };
 
 int zmk_hid_consumer_release(zmk_key_t code) {
     TOGGLE_CONSUMER(code, 0U);
+    MARK_DIRTY(ZMK_HID_REPORT_ID_CONSUMER);
     return 0;
 };
 
 void zmk_hid_consumer_clear(void) {
     memset(&consumer_report.body, 0, sizeof(consumer_report.body));
+    MARK_DIRTY(ZMK_HID_REPORT_ID_CONSUMER);
 }
 
 bool zmk_hid_consumer_is_pressed(zmk_key_t key) {
@@ -16,6 +16,10 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <dt-bindings/zmk/hid_usage_pages.h>
 #include <zmk/endpoints.h>
 
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+#include <zmk/latency.h>
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+
 static int hid_listener_keycode_pressed(const struct zmk_keycode_state_changed *ev) {
     int err, explicit_mods_changed, implicit_mods_changed;
 
@@ -99,6 +103,10 @@ static int hid_listener_keycode_released(const struct zmk_keycode_state_changed
 int hid_listener(const zmk_event_t *eh) {
     const struct zmk_keycode_state_changed *ev = as_zmk_keycode_state_changed(eh);
     if (ev) {
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+        zmk_latency_record(ZMK_LATENCY_STAGE_REPORT_BUILD);
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+
         if (ev->state) {
             hid_listener_keycode_pressed(ev);
         } else {
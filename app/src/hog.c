@@ -24,6 +24,9 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #if IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
 #include <zmk/hid_indicators.h>
 #endif // IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+#include <zmk/latency.h>
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
 
 enum {
     HIDS_REMOTE_WAKE = BIT(0),
@@ -304,164 +307,336 @@ K_THREAD_STACK_DEFINE(hog_q_stack, CONFIG_ZMK_BLE_THREAD_STACK_SIZE);
 
 struct k_work_q hog_work_q;
 
-K_MSGQ_DEFINE(zmk_hog_keyboard_msgq, sizeof(struct zmk_hid_keyboard_report_body),
-              CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE, 4);
+/*
+ * Reports waiting to be notified are kept per report type in small ring buffers. Queueing never
+ * blocks the caller: a report that doesn't change the queued state is folded into the newest
+ * queued report, and once a queue is full the newest queued report is replaced, so the oldest
+ * transitions still reach the host in order and the last report always reflects the latest state.
+ */
+struct hog_report_queue {
+    struct k_spinlock lock;
+    uint8_t *reports;
+    size_t report_size;
+    uint8_t capacity;
+    uint8_t head;
+    uint8_t len;
+    struct zmk_hog_report_queue_stats stats;
+};
+
+#define HOG_REPORT_QUEUE_DEFINE(name, report_type, size)                                           \
+    BUILD_ASSERT(size > 0 && size <= UINT8_MAX, "HID report queue size must be 1-255");            \
+    static report_type name##_reports[size];                                                       \
+    static struct hog_report_queue name = {                                                        \
+        .reports = (uint8_t *)name##_reports,                                                      \
+        .report_size = sizeof(report_type),                                                        \
+        .capacity = size,                                                                          \
+    }
+
+/*
+ * Fold `report` into the already queued report `queued`, returning false if they can't be
+ * combined without losing a state the host should see. With `force`, the queue is full and the
+ * reports must be combined as well as possible.
+ */
+typedef bool (*hog_report_merge_t)(void *queued, const void *report, bool force);
+
+static void *hog_report_queue_slot(struct hog_report_queue *queue, uint8_t index) {
+    return queue->reports + (index % queue->capacity) * queue->report_size;
+}
+
+static void hog_report_queue_put(struct hog_report_queue *queue, const void *report,
+                                 hog_report_merge_t merge) {
+    k_spinlock_key_t key = k_spin_lock(&queue->lock);
+    void *tail =
+        queue->len > 0 ? hog_report_queue_slot(queue, queue->head + queue->len - 1) : NULL;
+
+    if (tail && merge(tail, report, false)) {
+        queue->stats.coalesced++;
+    } else if (queue->len == queue->capacity) {
+        merge(tail, report, true);
+        queue->stats.dropped++;
+    } else {
+        memcpy(hog_report_queue_slot(queue, queue->head + queue->len), report,
+               queue->report_size);
+        queue->len++;
+        queue->stats.max_depth = MAX(queue->stats.max_depth, queue->len);
+    }
+
+    k_spin_unlock(&queue->lock, key);
+}
+
+static bool hog_report_queue_get(struct hog_report_queue *queue, void *report) {
+    k_spinlock_key_t key = k_spin_lock(&queue->lock);
+    bool found = queue->len > 0;
+
+    if (found) {
+        memcpy(report, hog_report_queue_slot(queue, queue->head), queue->report_size);
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->len--;
+    }
+
+    k_spin_unlock(&queue->lock, key);
+
+    return found;
+}
+
+static void hog_report_queue_get_stats(struct hog_report_queue *queue,
+                                       struct zmk_hog_report_queue_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&queue->lock);
+
+    *stats = queue->stats;
+    stats->depth = queue->len;
+
+    k_spin_unlock(&queue->lock, key);
+}
+
+// Keyboard and consumer reports are full states, so only exact repeats can be folded.
+static bool merge_state_report(void *queued, const void *report, size_t size, bool force) {
+    if (force) {
+        memcpy(queued, report, size);
+        return true;
+    }
+
+    return memcmp(queued, report, size) == 0;
+}
+
+static bool merge_keyboard_report(void *queued, const void *report, bool force) {
+    return merge_state_report(queued, report, sizeof(struct zmk_hid_keyboard_report_body), force);
+}
+
+static bool merge_consumer_report(void *queued, const void *report, bool force) {
+    return merge_state_report(queued, report, sizeof(struct zmk_hid_consumer_report_body), force);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT)
+
+/*
+ * The host stack doesn't expose connection event timing, so the completion of the last
+ * notification is used as an estimate of when a connection event happened. Reports are then
+ * held back and handed to the controller together shortly before the next expected event,
+ * which gives the queues a chance to coalesce reports arriving within one connection interval.
+ */
+static struct k_spinlock conn_event_lock;
+static k_ticks_t last_conn_event_ticks;
+
+static void send_aligned_reports_callback(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(hog_aligned_send_work, send_aligned_reports_callback);
+
+static k_timeout_t time_until_next_conn_event(void) {
+    uint32_t interval_us = zmk_ble_active_profile_conn_interval_us();
+
+    k_spinlock_key_t key = k_spin_lock(&conn_event_lock);
+    k_ticks_t last_ticks = last_conn_event_ticks;
+    k_spin_unlock(&conn_event_lock, key);
+
+    if (interval_us == 0 || last_ticks == 0) {
+        return K_NO_WAIT;
+    }
+
+    uint64_t since_us = k_ticks_to_us_floor64(k_uptime_ticks() - last_ticks);
+    uint32_t until_us = interval_us - (since_us % interval_us);
+
+    if (until_us <= CONFIG_ZMK_BLE_REPORT_CONN_EVENT_LEAD_US) {
+        return K_NO_WAIT;
+    }
+
+    return K_USEC(until_us - CONFIG_ZMK_BLE_REPORT_CONN_EVENT_LEAD_US);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT)
+
+static void submit_report_work(struct k_work *work) {
+#if IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT)
+    // Already scheduled work is left alone, so this report goes out with the pending ones.
+    k_work_schedule_for_queue(&hog_work_q, &hog_aligned_send_work, time_until_next_conn_event());
+#else
+    k_work_submit_to_queue(&hog_work_q, work);
+#endif // IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT)
+}
+
+HOG_REPORT_QUEUE_DEFINE(keyboard_queue, struct zmk_hid_keyboard_report_body,
+                        CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE);
+
+static void report_notify_sent(struct bt_conn *conn, void *user_data) {
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+    if (user_data == &keyboard_queue) {
+        zmk_latency_record(ZMK_LATENCY_STAGE_TRANSPORT_COMPLETE);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT)
+    k_spinlock_key_t key = k_spin_lock(&conn_event_lock);
+    last_conn_event_ticks = k_uptime_ticks();
+    k_spin_unlock(&conn_event_lock, key);
+#endif // IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT)
+}
+
+static int send_report(struct hog_report_queue *queue, const struct bt_gatt_attr *attr,
+                       const void *report, size_t len) {
+    struct bt_conn *conn = zmk_ble_active_profile_conn();
+    if (conn == NULL) {
+        return -ENOTCONN;
+    }
+
+    struct bt_gatt_notify_params notify_params = {
+        .attr = attr,
+        .data = report,
+        .len = len,
+        .func = (IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS) ||
+                 IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT))
+                    ? report_notify_sent
+                    : NULL,
+        .user_data = queue,
+    };
+
+    int err = bt_gatt_notify_cb(conn, &notify_params);
+    if (err == -EPERM) {
+        bt_conn_set_security(conn, BT_SECURITY_L2);
+    } else if (err) {
+        LOG_DBG("Error notifying %d", err);
+    }
+
+    bt_conn_unref(conn);
+
+    return err;
+}
 
 void send_keyboard_report_callback(struct k_work *work) {
     struct zmk_hid_keyboard_report_body report;
 
-    while (k_msgq_get(&zmk_hog_keyboard_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
+    while (hog_report_queue_get(&keyboard_queue, &report)) {
+        if (send_report(&keyboard_queue, &hog_svc.attrs[5], &report, sizeof(report)) ==
+            -ENOTCONN) {
             return;
         }
-
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[5],
-            .data = &report,
-            .len = sizeof(report),
-        };
-
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
-        }
-
-        bt_conn_unref(conn);
     }
 }
 
 K_WORK_DEFINE(hog_keyboard_work, send_keyboard_report_callback);
 
 int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_keyboard_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Keyboard message queue full, popping first message and queueing again");
-            struct zmk_hid_keyboard_report_body discarded_report;
-            k_msgq_get(&zmk_hog_keyboard_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_keyboard_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue keyboard report to send (%d)", err);
-            return err;
-        }
-    }
+    hog_report_queue_put(&keyboard_queue, report, merge_keyboard_report);
 
-    k_work_submit_to_queue(&hog_work_q, &hog_keyboard_work);
+    submit_report_work(&hog_keyboard_work);
 
     return 0;
 };
 
-K_MSGQ_DEFINE(zmk_hog_consumer_msgq, sizeof(struct zmk_hid_consumer_report_body),
-              CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE, 4);
+HOG_REPORT_QUEUE_DEFINE(consumer_queue, struct zmk_hid_consumer_report_body,
+                        CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE);
 
 void send_consumer_report_callback(struct k_work *work) {
     struct zmk_hid_consumer_report_body report;
 
-    while (k_msgq_get(&zmk_hog_consumer_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
+    while (hog_report_queue_get(&consumer_queue, &report)) {
+        if (send_report(&consumer_queue, &hog_svc.attrs[9], &report, sizeof(report)) ==
+            -ENOTCONN) {
             return;
         }
-
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[9],
-            .data = &report,
-            .len = sizeof(report),
-        };
-
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
-        }
-
-        bt_conn_unref(conn);
     }
 };
 
 K_WORK_DEFINE(hog_consumer_work, send_consumer_report_callback);
 
 int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_consumer_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_hid_consumer_report_body discarded_report;
-            k_msgq_get(&zmk_hog_consumer_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_consumer_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue consumer report to send (%d)", err);
-            return err;
-        }
-    }
+    hog_report_queue_put(&consumer_queue, report, merge_consumer_report);
 
-    k_work_submit_to_queue(&hog_work_q, &hog_consumer_work);
+    submit_report_work(&hog_consumer_work);
 
     return 0;
 };
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 
-K_MSGQ_DEFINE(zmk_hog_mouse_msgq, sizeof(struct zmk_hid_mouse_report_body),
-              CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE, 4);
+HOG_REPORT_QUEUE_DEFINE(mouse_queue, struct zmk_hid_mouse_report_body,
+                        CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE);
+
+static bool add_mouse_delta(int16_t *queued, int16_t delta, bool force) {
+    int32_t sum = (int32_t)*queued + delta;
+
+    if (!force && (sum > INT16_MAX || sum < INT16_MIN)) {
+        return false;
+    }
+
+    *queued = CLAMP(sum, INT16_MIN, INT16_MAX);
+    return true;
+}
+
+// Movement and scrolling are relative, so they accumulate as long as the buttons don't change.
+static bool merge_mouse_report(void *queued, const void *report, bool force) {
+    struct zmk_hid_mouse_report_body *q = queued;
+    const struct zmk_hid_mouse_report_body *r = report;
+    struct zmk_hid_mouse_report_body merged = *q;
+
+    if (!force && q->buttons != r->buttons) {
+        return false;
+    }
+
+    merged.buttons = r->buttons;
+    if (!add_mouse_delta(&merged.d_x, r->d_x, force) ||
+        !add_mouse_delta(&merged.d_y, r->d_y, force) ||
+        !add_mouse_delta(&merged.d_scroll_y, r->d_scroll_y, force) ||
+        !add_mouse_delta(&merged.d_scroll_x, r->d_scroll_x, force)) {
+        return false;
+    }
+
+    *q = merged;
+    return true;
+}
 
 void send_mouse_report_callback(struct k_work *work) {
     struct zmk_hid_mouse_report_body report;
-    while (k_msgq_get(&zmk_hog_mouse_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
-        }
 
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[13],
-            .data = &report,
-            .len = sizeof(report),
-        };
-
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
+    while (hog_report_queue_get(&mouse_queue, &report)) {
+        if (send_report(&mouse_queue, &hog_svc.attrs[13], &report, sizeof(report)) ==
+            -ENOTCONN) {
+            return;
         }
-
-        bt_conn_unref(conn);
     }
 };
 
 K_WORK_DEFINE(hog_mouse_work, send_mouse_report_callback);
 
 int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_mouse_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_hid_mouse_report_body discarded_report;
-            k_msgq_get(&zmk_hog_mouse_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_mouse_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue mouse report to send (%d)", err);
-            return err;
-        }
-    }
+    hog_report_queue_put(&mouse_queue, report, merge_mouse_report);
 
-    k_work_submit_to_queue(&hog_work_q, &hog_mouse_work);
+    submit_report_work(&hog_mouse_work);
 
     return 0;
 };
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
+#if IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT)
+
+static void send_aligned_reports_callback(struct k_work *work) {
+    send_keyboard_report_callback(NULL);
+    send_consumer_report_callback(NULL);
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    send_mouse_report_callback(NULL);
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_BLE_REPORT_CONN_EVENT_ALIGNMENT)
+
+int zmk_hog_get_report_queue_stats(enum zmk_hog_report_type type,
+                                   struct zmk_hog_report_queue_stats *stats) {
+    switch (type) {
+    case ZMK_HOG_REPORT_TYPE_KEYBOARD:
+        hog_report_queue_get_stats(&keyboard_queue, stats);
+        return 0;
+    case ZMK_HOG_REPORT_TYPE_CONSUMER:
+        hog_report_queue_get_stats(&consumer_queue, stats);
+        return 0;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    case ZMK_HOG_REPORT_TYPE_MOUSE:
+        hog_report_queue_get_stats(&mouse_queue, stats);
+        return 0;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+    default:
+        return -ENOTSUP;
+    }
+}
+
 static int zmk_hog_init(void) {
     static const struct k_work_queue_config queue_config = {.name = "HID Over GATT Send Work"};
     k_work_queue_start(&hog_work_q, hog_q_stack, K_THREAD_STACK_SIZEOF(hog_q_stack),
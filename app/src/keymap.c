@@ -6,6 +6,7 @@
 
 #include <drivers/behavior.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/sys/crc.h>
 #include <zephyr/settings/settings.h>
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -66,6 +67,27 @@ static zmk_keymap_layer_id_t _zmk_keymap_layer_default = 0;
 // still send the release event to the behavior in that layer also.
 static uint32_t zmk_keymap_active_behavior_layer[ZMK_KEYMAP_LEN];
 
+// The binding each position resolves to on the highest active layer, along with its behavior
+// device, so the common press/release path doesn't need to walk the layers, map the position and
+// look up the behavior by name. Any change to the layer state, layer order, physical layout or
+// bindings bumps the generation, and stale entries are re-resolved the next time they are used.
+struct position_binding_cache_entry {
+    uint32_t generation;
+    zmk_keymap_layer_index_t layer_idx;
+    const struct zmk_behavior_binding *binding;
+    const struct device *behavior;
+};
+
+static struct position_binding_cache_entry position_binding_cache[ZMK_KEYMAP_LEN];
+static uint32_t position_binding_cache_generation = 1;
+
+static void invalidate_position_binding_cache(void) {
+    // Generation 0 is reserved for entries that have never been resolved.
+    if (++position_binding_cache_generation == 0) {
+        position_binding_cache_generation = 1;
+    }
+}
+
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
 static uint8_t keymap_layer_orders[ZMK_KEYMAP_LAYERS_LEN];
@@ -81,7 +103,10 @@ static uint8_t keymap_layer_orders[ZMK_KEYMAP_LAYERS_LEN];
                          (DT_INST_FOREACH_CHILD_STATUS_OKAY_SEP(0, TRANSFORMED_LAYER, (, ))))),    \
             (0))};
 
-KEYMAP_VAR(zmk_keymap, COND_CODE_1(IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE), (), (const)),
+KEYMAP_VAR(zmk_keymap,
+           COND_CODE_1(UTIL_OR(IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE),
+                               IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)),
+                       (), (const)),
            IS_ENABLED(CONFIG_ZMK_STUDIO))
 
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
@@ -150,6 +175,7 @@ static inline int set_layer_state(zmk_keymap_layer_id_t layer_id, bool state) {
     WRITE_BIT(_zmk_keymap_layer_state, layer_id, state);
     // Don't send state changes unless there was an actual change
     if (old_state != _zmk_keymap_layer_state) {
+        invalidate_position_binding_cache();
         LOG_DBG("layer_changed: layer %d state %d", layer_id, state);
         ret = raise_layer_state_changed(layer_id, state);
         if (ret < 0) {
@@ -290,6 +316,8 @@ int zmk_keymap_set_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint8_t
         return -EINVAL;
     }
 
+    zmk_behavior_resolve_binding_device(&binding);
+
     if (memcmp(&zmk_keymap[layer_id][storage_binding_idx], &binding, sizeof(binding)) == 0) {
         LOG_DBG("Not setting, no change to layer %d at index %d (%d)", layer_id, binding_idx,
                 storage_binding_idx);
@@ -302,6 +330,7 @@ int zmk_keymap_set_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint8_t
 
     // TODO: Need a mutex to protect access to the keymap data?
     memcpy(&zmk_keymap[layer_id][storage_binding_idx], &binding, sizeof(binding));
+    invalidate_position_binding_cache();
 
     return 0;
 }
@@ -346,6 +375,8 @@ int zmk_keymap_move_layer(zmk_keymap_layer_index_t start_idx, zmk_keymap_layer_i
         keymap_layer_orders[dest_idx] = val;
     }
 
+    invalidate_position_binding_cache();
+
     return 0;
 }
 
@@ -364,6 +395,7 @@ int zmk_keymap_add_layer(void) {
         for (int candidate_id = 0; candidate_id < ZMK_KEYMAP_LAYERS_LEN; candidate_id++) {
             if (!(seen_layer_ids & BIT(candidate_id))) {
                 keymap_layer_orders[index] = candidate_id;
+                invalidate_position_binding_cache();
                 return index;
             }
         }
@@ -388,6 +420,7 @@ int zmk_keymap_remove_layer(zmk_keymap_layer_index_t index) {
     }
 
     keymap_layer_orders[ZMK_KEYMAP_LAYERS_LEN - 1] = ZMK_KEYMAP_LAYER_ID_INVAL;
+    invalidate_position_binding_cache();
 
     LOG_HEXDUMP_DBG(keymap_layer_orders, ZMK_KEYMAP_LAYERS_LEN, "Order");
 
@@ -403,6 +436,7 @@ int zmk_keymap_restore_layer(zmk_keymap_layer_id_t id, zmk_keymap_layer_index_t
     }
 
     keymap_layer_orders[at_index] = id;
+    invalidate_position_binding_cache();
 
     return 0;
 }
@@ -481,6 +515,145 @@ int zmk_keymap_check_unsaved_changes(void) {
 #define LAYER_NAME_SETTINGS_KEY "keymap/l_n/%d"
 #define LAYER_BINDING_SETTINGS_KEY "keymap/l/%d/%d"
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+
+#define LAYER_PACKED_SETTINGS_KEY "keymap/lp/%d"
+#define LAYER_PACKED_SETTINGS_VERSION 1
+
+struct zmk_keymap_layer_settings_header {
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t count;
+    uint32_t crc;
+} __packed;
+
+struct zmk_keymap_layer_settings_entry {
+    uint16_t position;
+    struct zmk_behavior_binding_setting binding;
+} __packed;
+
+struct zmk_keymap_layer_settings {
+    struct zmk_keymap_layer_settings_header header;
+    struct zmk_keymap_layer_settings_entry entries[ZMK_KEYMAP_LEN];
+} __packed;
+
+// Positions on each layer that have a stored binding, i.e. the contents of the packed record.
+static uint8_t zmk_keymap_layer_stored[ZMK_KEYMAP_LAYERS_LEN][PENDING_ARRAY_SIZE];
+
+// Positions loaded from per-binding records that still need migrating to the packed record.
+static uint8_t zmk_keymap_layer_legacy[ZMK_KEYMAP_LAYERS_LEN][PENDING_ARRAY_SIZE];
+
+static struct zmk_keymap_layer_settings layer_settings_buf;
+static K_MUTEX_DEFINE(layer_settings_buf_lock);
+
+static int save_layer_packed(zmk_keymap_layer_id_t layer) {
+    uint8_t *stored = zmk_keymap_layer_stored[layer];
+    uint16_t count = 0;
+
+    k_mutex_lock(&layer_settings_buf_lock, K_FOREVER);
+
+    for (int kp = 0; kp < ZMK_KEYMAP_LEN; kp++) {
+        if (!(stored[kp / 8] & BIT(kp % 8))) {
+            continue;
+        }
+
+        const struct zmk_behavior_binding *binding = &zmk_keymap[layer][kp];
+        layer_settings_buf.entries[count++] = (struct zmk_keymap_layer_settings_entry){
+            .position = kp,
+            .binding =
+                {
+                    .behavior_local_id = zmk_behavior_get_local_id(binding->behavior_dev),
+                    .param1 = binding->param1,
+                    .param2 = binding->param2,
+                },
+        };
+    }
+
+    size_t entries_len = count * sizeof(struct zmk_keymap_layer_settings_entry);
+    layer_settings_buf.header = (struct zmk_keymap_layer_settings_header){
+        .version = LAYER_PACKED_SETTINGS_VERSION,
+        .count = count,
+        .crc = crc32_ieee((const uint8_t *)layer_settings_buf.entries, entries_len),
+    };
+
+    LOG_DBG("Saving %d bindings for layer %d in a single record", count, layer);
+
+    char setting_name[14];
+    sprintf(setting_name, LAYER_PACKED_SETTINGS_KEY, layer);
+    int ret = settings_save_one(setting_name, &layer_settings_buf,
+                                sizeof(struct zmk_keymap_layer_settings_header) + entries_len);
+
+    k_mutex_unlock(&layer_settings_buf_lock);
+
+    return ret;
+}
+
+static int save_bindings(void) {
+    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
+        uint8_t *pending = zmk_keymap_layer_pending_changes[l];
+        uint8_t *stored = zmk_keymap_layer_stored[l];
+        bool changed = false;
+
+        for (int i = 0; i < PENDING_ARRAY_SIZE; i++) {
+            if (pending[i]) {
+                stored[i] |= pending[i];
+                changed = true;
+            }
+        }
+
+        if (!changed) {
+            continue;
+        }
+
+        int ret = save_layer_packed(l);
+        if (ret < 0) {
+            LOG_ERR("Failed to save keymap bindings for layer %d (%d)", l, ret);
+            return ret;
+        }
+
+        memset(pending, 0, PENDING_ARRAY_SIZE);
+    }
+
+    return 0;
+}
+
+static void migrate_legacy_bindings(struct k_work *work) {
+    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
+        uint8_t *legacy = zmk_keymap_layer_legacy[l];
+        bool found = false;
+
+        for (int i = 0; i < PENDING_ARRAY_SIZE; i++) {
+            found |= legacy[i] != 0;
+        }
+
+        if (!found) {
+            continue;
+        }
+
+        // Only drop the per-binding records once the packed record holding them is stored.
+        int ret = save_layer_packed(l);
+        if (ret < 0) {
+            LOG_ERR("Failed to migrate keymap bindings for layer %d (%d)", l, ret);
+            continue;
+        }
+
+        for (int kp = 0; kp < ZMK_KEYMAP_LEN; kp++) {
+            if (legacy[kp / 8] & BIT(kp % 8)) {
+                char setting_name[20];
+                sprintf(setting_name, LAYER_BINDING_SETTINGS_KEY, l, kp);
+                settings_delete(setting_name);
+            }
+        }
+
+        memset(legacy, 0, PENDING_ARRAY_SIZE);
+        LOG_INF("Migrated keymap bindings for layer %d to a single record", l);
+    }
+}
+
+static K_WORK_DEFINE(migrate_legacy_bindings_work, migrate_legacy_bindings);
+
+#else
+
 static int save_bindings(void) {
     for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
         uint8_t *pending = zmk_keymap_layer_pending_changes[l];
@@ -526,6 +699,8 @@ static int save_bindings(void) {
     return 0;
 }
 
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 static int save_layer_orders(void) {
     int ret = settings_save_one(LAYER_ORDER_SETTINGS_KEY, keymap_layer_orders,
@@ -586,6 +761,8 @@ static void load_stock_keymap_layer_ordering() {
         keymap_layer_orders[i] = ZMK_KEYMAP_LAYER_ID_INVAL;
         i++;
     }
+
+    invalidate_position_binding_cache();
 }
 #endif
 
@@ -593,14 +770,22 @@ static void reload_from_stock_keymap(void) {
     for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
         for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
             zmk_keymap[l][k] = zmk_stock_keymap[l][k];
+            zmk_behavior_resolve_binding_device(&zmk_keymap[l][k]);
         }
     }
+
+    invalidate_position_binding_cache();
 }
 
 int zmk_keymap_discard_changes(void) {
     load_stock_keymap_layer_ordering();
     reload_from_stock_keymap();
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+    memset(zmk_keymap_layer_stored, 0, sizeof(zmk_keymap_layer_stored));
+    memset(zmk_keymap_layer_legacy, 0, sizeof(zmk_keymap_layer_legacy));
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+
     int ret = settings_load_subtree("keymap");
     if (ret >= 0) {
         changed_layer_names = 0;
@@ -651,6 +836,15 @@ int zmk_keymap_reset_settings(void) {
         sprintf(layer_name_setting_name, LAYER_NAME_SETTINGS_KEY, l);
         settings_delete(layer_name_setting_name);
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+        char packed_setting_name[14];
+        sprintf(packed_setting_name, LAYER_PACKED_SETTINGS_KEY, l);
+        settings_delete(packed_setting_name);
+
+        memset(zmk_keymap_layer_stored[l], 0, PENDING_ARRAY_SIZE);
+        memset(zmk_keymap_layer_legacy[l], 0, PENDING_ARRAY_SIZE);
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+
         uint8_t *changes = zmk_keymap_layer_changes[l];
 
         for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
@@ -704,14 +898,68 @@ int zmk_keymap_apply_position_state(uint8_t source, zmk_keymap_layer_id_t layer_
     return zmk_behavior_invoke_binding(binding, event, pressed);
 }
 
+static const struct position_binding_cache_entry *get_cached_position_binding(uint32_t position) {
+    struct position_binding_cache_entry *entry = &position_binding_cache[position];
+
+    if (entry->generation != position_binding_cache_generation) {
+        entry->layer_idx = zmk_keymap_highest_layer_active();
+        entry->binding =
+            zmk_keymap_get_layer_binding_at_idx(LAYER_INDEX_TO_ID(entry->layer_idx), position);
+        entry->behavior = entry->binding ? zmk_behavior_get_binding_device(entry->binding) : NULL;
+        entry->generation = position_binding_cache_generation;
+    }
+
+    return entry;
+}
+
+static int apply_cached_position_state(uint8_t source, uint32_t position, bool pressed,
+                                       int64_t timestamp,
+                                       const struct position_binding_cache_entry *entry) {
+    zmk_keymap_layer_id_t layer_id = LAYER_INDEX_TO_ID(entry->layer_idx);
+    struct zmk_behavior_binding_event event = {
+        .layer = layer_id,
+        .position = position,
+        .timestamp = timestamp,
+#if IS_ENABLED(CONFIG_ZMK_SPLIT)
+        .source = source,
+#endif
+    };
+
+    LOG_DBG("layer_id: %d position: %d, binding name: %s", layer_id, position,
+            entry->binding->behavior_dev);
+
+    return zmk_behavior_invoke_resolved_binding(entry->binding, entry->behavior, event, pressed);
+}
+
 int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pressed,
                                       int64_t timestamp) {
     if (pressed) {
         zmk_keymap_active_behavior_layer[position] = _zmk_keymap_layer_state;
     }
 
+    int start_layer_idx = ZMK_KEYMAP_LAYERS_LEN - 1;
+
+    // If the layer state is unchanged since the press, the binding on the highest active layer
+    // comes straight from the cache, and only transparent bindings need the layer walk below.
+    if (zmk_keymap_active_behavior_layer[position] == _zmk_keymap_layer_state) {
+        const struct position_binding_cache_entry *entry = get_cached_position_binding(position);
+
+        if (entry->binding) {
+            int ret = apply_cached_position_state(source, position, pressed, timestamp, entry);
+            if (ret < 0) {
+                LOG_DBG("Behavior returned error: %d", ret);
+                return ret;
+            } else if (ret == 0) {
+                return ret;
+            }
+
+            LOG_DBG("behavior processing to continue to next layer");
+            start_layer_idx = entry->layer_idx - 1;
+        }
+    }
+
     // We use int here to be sure we don't loop layer_idx back to UINT8_MAX
-    for (int layer_idx = ZMK_KEYMAP_LAYERS_LEN - 1;
+    for (int layer_idx = start_layer_idx;
          layer_idx >= LAYER_ID_TO_INDEX(_zmk_keymap_layer_default); layer_idx--) {
         zmk_keymap_layer_id_t layer_id = LAYER_INDEX_TO_ID(layer_idx);
 
@@ -755,7 +1003,7 @@ int zmk_keymap_sensor_event(uint8_t sensor_index,
         LOG_DBG("layer idx: %d, layer id: %d sensor_index: %d, binding name: %s", layer_idx,
                 layer_id, sensor_index, binding->behavior_dev);
 
-        const struct device *behavior = zmk_behavior_get_binding(binding->behavior_dev);
+        const struct device *behavior = zmk_behavior_get_binding_device(binding);
         if (!behavior) {
             LOG_DBG("No behavior assigned to %d on layer %d", sensor_index, layer_id);
             continue;
@@ -815,11 +1063,18 @@ int keymap_listener(const zmk_event_t *eh) {
     }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
+    if (as_zmk_physical_layout_selection_changed(eh) != NULL) {
+        // Positions map to different stock bindings in the new layout
+        invalidate_position_binding_cache();
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
     return -ENOTSUP;
 }
 
 ZMK_LISTENER(keymap, keymap_listener);
 ZMK_SUBSCRIPTION(keymap, zmk_position_state_changed);
+ZMK_SUBSCRIPTION(keymap, zmk_physical_layout_selection_changed);
 
 #if ZMK_KEYMAP_HAS_SENSORS
 ZMK_SUBSCRIPTION(keymap, zmk_sensor_event);
@@ -827,6 +1082,84 @@ ZMK_SUBSCRIPTION(keymap, zmk_sensor_event);
 
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
 
+static void load_binding_setting(zmk_keymap_layer_id_t layer, uint32_t key_position,
+                                 const struct zmk_behavior_binding_setting *binding_setting) {
+    const char *name =
+        zmk_behavior_find_behavior_name_from_local_id(binding_setting->behavior_local_id);
+
+    if (!name) {
+        LOG_WRN("Loaded device %d from settings but no device found by that local ID",
+                binding_setting->behavior_local_id);
+    }
+
+    zmk_keymap[layer][key_position] = (struct zmk_behavior_binding){
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
+        .local_id = binding_setting->behavior_local_id,
+#endif
+        .behavior_dev = name,
+        .param1 = binding_setting->param1,
+        .param2 = binding_setting->param2,
+    };
+    zmk_behavior_resolve_binding_device(&zmk_keymap[layer][key_position]);
+    invalidate_position_binding_cache();
+}
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+
+static int apply_layer_packed(zmk_keymap_layer_id_t layer, size_t len) {
+    const struct zmk_keymap_layer_settings_header *header = &layer_settings_buf.header;
+    size_t entries_len = header->count * sizeof(struct zmk_keymap_layer_settings_entry);
+
+    if (header->version != LAYER_PACKED_SETTINGS_VERSION) {
+        LOG_WRN("Unsupported packed layer version %d for layer %d", header->version, layer);
+        return -EINVAL;
+    }
+
+    if (sizeof(*header) + entries_len != len ||
+        crc32_ieee((const uint8_t *)layer_settings_buf.entries, entries_len) != header->crc) {
+        LOG_ERR("Corrupt packed keymap settings for layer %d, ignoring them", layer);
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < header->count; i++) {
+        const struct zmk_keymap_layer_settings_entry *entry = &layer_settings_buf.entries[i];
+
+        if (entry->position >= ZMK_KEYMAP_LEN) {
+            LOG_WRN("Key position %d is larger than max of %d", entry->position, ZMK_KEYMAP_LEN);
+            continue;
+        }
+
+        load_binding_setting(layer, entry->position, &entry->binding);
+        WRITE_BIT(zmk_keymap_layer_stored[layer][entry->position / 8], entry->position % 8, 1);
+    }
+
+    return 0;
+}
+
+static int load_layer_packed(zmk_keymap_layer_id_t layer, size_t len, settings_read_cb read_cb,
+                             void *cb_arg) {
+    if (len < sizeof(struct zmk_keymap_layer_settings_header) ||
+        len > sizeof(layer_settings_buf)) {
+        LOG_ERR("Invalid packed layer setting size %d for layer %d", len, layer);
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&layer_settings_buf_lock, K_FOREVER);
+
+    int ret = read_cb(cb_arg, &layer_settings_buf, len);
+    if (ret <= 0) {
+        LOG_ERR("Failed to handle packed keymap layer from settings (err %d)", ret);
+    } else {
+        ret = apply_layer_packed(layer, len);
+    }
+
+    k_mutex_unlock(&layer_settings_buf_lock);
+
+    return ret;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+
 static int keymap_handle_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
     const char *next;
 
@@ -891,23 +1224,30 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
             return err;
         }
 
-        const char *name =
-            zmk_behavior_find_behavior_name_from_local_id(binding_setting.behavior_local_id);
+        load_binding_setting(layer, key_position, &binding_setting);
 
-        if (!name) {
-            LOG_WRN("Loaded device %d from settings but no device found by that local ID",
-                    binding_setting.behavior_local_id);
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+        WRITE_BIT(zmk_keymap_layer_stored[layer][key_position / 8], key_position % 8, 1);
+        WRITE_BIT(zmk_keymap_layer_legacy[layer][key_position / 8], key_position % 8, 1);
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+    }
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+    else if (settings_name_steq(name, "lp", &next) && next) {
+        char *endptr;
+        uint8_t layer = strtoul(next, &endptr, 10);
+        if (*endptr != '\0') {
+            LOG_WRN("Invalid layer number: %s with endptr %s", next, endptr);
+            return -EINVAL;
         }
 
-        zmk_keymap[layer][key_position] = (struct zmk_behavior_binding){
-#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
-            .local_id = binding_setting.behavior_local_id,
-#endif
-            .behavior_dev = name,
-            .param1 = binding_setting.param1,
-            .param2 = binding_setting.param2,
-        };
+        if (layer >= ZMK_KEYMAP_LAYERS_LEN) {
+            LOG_WRN("Layer %d is larger than max of %d", layer, ZMK_KEYMAP_LAYERS_LEN);
+            return -EINVAL;
+        }
+
+        return load_layer_packed(layer, len, read_cb, cb_arg);
     }
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
     else if (settings_name_steq(name, "layer_order", &next) && !next) {
         int err =
@@ -922,6 +1262,7 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
 
         memcpy(keymap_layer_orders, settings_layer_orders,
                MIN(len, ARRAY_SIZE(settings_layer_orders)));
+        invalidate_position_binding_cache();
     }
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
@@ -929,6 +1270,10 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
 };
 
 static int keymap_handle_commit(void) {
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+    k_work_submit(&migrate_legacy_bindings_work);
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_PACKED_LAYERS)
+
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
     for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
         for (int p = 0; p < ZMK_KEYMAP_LEN; p++) {
@@ -942,9 +1287,13 @@ static int keymap_handle_commit(void) {
                     LOG_ERR("Failed to finding device for local ID %d after settings load",
                             binding->local_id);
                 }
+
+                zmk_behavior_resolve_binding_device(binding);
             }
         }
     }
+
+    invalidate_position_binding_cache();
 #endif
 
     return 0;
@@ -955,6 +1304,27 @@ SETTINGS_STATIC_HANDLER_DEFINE(keymap, "keymap", NULL, keymap_handle_set, keymap
 
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
 
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+
+static void resolve_keymap_binding_devices(void) {
+    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
+#if !IS_ENABLED(CONFIG_ZMK_STUDIO)
+        // With Studio enabled, the bindings are resolved as they are copied from the stock keymap
+        for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
+            zmk_behavior_resolve_binding_device(&zmk_keymap[l][k]);
+        }
+#endif
+
+#if ZMK_KEYMAP_HAS_SENSORS
+        for (int s = 0; s < ZMK_KEYMAP_SENSORS_LEN; s++) {
+            zmk_behavior_resolve_binding_device(&zmk_sensor_keymap[l][s]);
+        }
+#endif /* ZMK_KEYMAP_HAS_SENSORS */
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+
 int keymap_init(void) {
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
     load_stock_keymap_layer_ordering();
@@ -962,6 +1332,9 @@ int keymap_init(void) {
 #if IS_ENABLED(CONFIG_ZMK_STUDIO)
     reload_from_stock_keymap();
 #endif
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+    resolve_keymap_binding_devices();
+#endif
 
     return 0;
 }
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/spinlock.h>
+#include <string.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/latency.h>
+
+static struct zmk_latency_histogram histograms[ZMK_LATENCY_STAGE_COUNT];
+static struct k_spinlock lock;
+
+static uint32_t capture_cycles;
+static atomic_t pending_stages;
+
+static const char *stage_names[ZMK_LATENCY_STAGE_COUNT] = {
+    [ZMK_LATENCY_STAGE_DISPATCH] = "dispatch",
+    [ZMK_LATENCY_STAGE_REPORT_BUILD] = "report",
+    [ZMK_LATENCY_STAGE_TRANSPORT_COMPLETE] = "transport",
+};
+
+static uint8_t bucket_for(uint32_t us) {
+    if (us == 0) {
+        return 0;
+    }
+
+    uint8_t bucket = 32 - __builtin_clz(us);
+    return MIN(bucket, ZMK_LATENCY_HISTOGRAM_BUCKETS - 1);
+}
+
+void zmk_latency_capture(void) {
+    capture_cycles = k_cycle_get_32();
+    atomic_set(&pending_stages, BIT_MASK(ZMK_LATENCY_STAGE_COUNT));
+}
+
+void zmk_latency_record(enum zmk_latency_stage stage) {
+    if (stage >= ZMK_LATENCY_STAGE_COUNT || !atomic_test_and_clear_bit(&pending_stages, stage)) {
+        return;
+    }
+
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - capture_cycles);
+
+    K_SPINLOCK(&lock) {
+        struct zmk_latency_histogram *hist = &histograms[stage];
+        hist->buckets[bucket_for(us)]++;
+        hist->count++;
+        hist->max_us = MAX(hist->max_us, us);
+    }
+}
+
+int zmk_latency_get_histogram(enum zmk_latency_stage stage, struct zmk_latency_histogram *hist) {
+    if (stage >= ZMK_LATENCY_STAGE_COUNT) {
+        return -EINVAL;
+    }
+
+    K_SPINLOCK(&lock) { *hist = histograms[stage]; }
+
+    return 0;
+}
+
+void zmk_latency_reset(void) {
+    K_SPINLOCK(&lock) { memset(histograms, 0, sizeof(histograms)); }
+}
+
+void zmk_latency_log_histograms(void) {
+    for (int s = 0; s < ZMK_LATENCY_STAGE_COUNT; s++) {
+        struct zmk_latency_histogram hist;
+        zmk_latency_get_histogram(s, &hist);
+
+        LOG_INF("%s: %d samples, max %dus", stage_names[s], hist.count, hist.max_us);
+        for (int b = 0; b < ZMK_LATENCY_HISTOGRAM_BUCKETS; b++) {
+            if (hist.buckets[b] == 0) {
+                continue;
+            }
+
+            LOG_INF("%s: <%dus: %d", stage_names[s], BIT(b), hist.buckets[b]);
+        }
+    }
+}
+
+#if CONFIG_ZMK_LATENCY_METRICS_LOG_INTERVAL_MS > 0
+
+static void latency_log_work_cb(struct k_work *work) {
+    zmk_latency_log_histograms();
+    k_work_schedule((struct k_work_delayable *)work,
+                    K_MSEC(CONFIG_ZMK_LATENCY_METRICS_LOG_INTERVAL_MS));
+}
+
+static K_WORK_DELAYABLE_DEFINE(latency_log_work, latency_log_work_cb);
+
+static int latency_init(void) {
+    k_work_schedule(&latency_log_work, K_MSEC(CONFIG_ZMK_LATENCY_METRICS_LOG_INTERVAL_MS));
+    return 0;
+}
+
+SYS_INIT(latency_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+#endif // CONFIG_ZMK_LATENCY_METRICS_LOG_INTERVAL_MS > 0
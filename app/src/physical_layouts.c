@@ -23,6 +23,10 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
 
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+#include <zmk/latency.h>
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+
 ZMK_EVENT_IMPL(zmk_physical_layout_selection_changed);
 
 #define DT_DRV_COMPAT zmk_physical_layout
@@ -171,6 +175,7 @@ struct zmk_kscan_event {
     uint32_t row;
     uint32_t column;
     uint32_t state;
+    int64_t timestamp;
 };
 
 static struct zmk_kscan_msg_processor {
@@ -189,7 +194,14 @@ static void zmk_physical_layout_kscan_callback(const struct device *dev, uint32_
     struct zmk_kscan_event ev = {
         .row = row,
         .column = column,
-        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED)};
+        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED),
+        // Stamp the event when the kscan driver reports it, not when the work queue gets around to
+        // processing it, so queueing delay doesn't skew hold-tap/combo timing.
+        .timestamp = k_uptime_get()};
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+    zmk_latency_capture();
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
 
     k_msgq_put(&physical_layouts_kscan_msgq, &ev, K_NO_WAIT);
     k_work_submit(&msg_processor.work);
@@ -211,11 +223,16 @@ static void zmk_physical_layouts_kscan_process_msgq(struct k_work *item) {
 
         LOG_DBG("Row: %d, col: %d, position: %d, pressed: %s", ev.row, ev.column, position,
                 (pressed ? "true" : "false"));
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+        zmk_latency_record(ZMK_LATENCY_STAGE_DISPATCH);
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+
         raise_zmk_position_state_changed(
             (struct zmk_position_state_changed){.source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL,
                                                 .state = pressed,
                                                 .position = position,
-                                                .timestamp = k_uptime_get()});
+                                                .timestamp = ev.timestamp});
     }
 }
 
@@ -27,6 +27,10 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/hid.h>
 #include <zmk/keymap.h>
 
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_ACCUMULATE_REPORTS)
+#include <zmk/timer.h>
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_ACCUMULATE_REPORTS)
+
 #define ONE_IF_DEV_OK(n)                                                                           \
     COND_CODE_1(DT_NODE_HAS_STATUS(DT_INST_PHANDLE(n, device), okay), (1 +), (0 +))
 
@@ -41,7 +45,7 @@ enum input_listener_xy_data_mode {
 };
 
 struct input_listener_axis_data {
-    int16_t value;
+    int32_t value;
 };
 
 struct input_listener_xy_data {
@@ -77,6 +81,45 @@ struct input_listener_config {
     struct input_listener_layer_override layer_overrides[];
 };
 
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAINS)
+
+// Relative codes that fused steps precompute, the same ones remainders are tracked for.
+static const uint16_t fused_codes[] = {INPUT_REL_X, INPUT_REL_Y, INPUT_REL_WHEEL,
+                                       INPUT_REL_HWHEEL};
+
+// A run of scalers, transforms and code mappers applied to one input code in a single step.
+struct input_listener_fused_code {
+    uint16_t code;
+    int8_t sign_before;
+    int8_t sign_after;
+    int32_t mul;
+    int32_t div;
+    int16_t *remainder;
+};
+
+struct input_listener_step {
+    const struct zmk_input_processor_entry *processors;
+    // Remainders of the first processor in the step that tracks them, the others follow in order.
+    struct input_processor_remainder_data *remainders;
+    uint8_t processors_len;
+    // Step to continue with when a processor stops the event, the end of its override or base
+    // config, unless stopping ends processing of the event altogether.
+    uint8_t segment_end;
+    bool stop_propagates;
+    bool fused;
+    struct input_listener_fused_code fused_codes[ARRAY_SIZE(fused_codes)];
+};
+
+struct input_listener_chain {
+    bool compiled;
+    bool too_long;
+    zmk_keymap_layers_state_t layer_state;
+    uint8_t steps_len;
+    struct input_listener_step steps[CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAIN_MAX_STEPS];
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAINS)
+
 struct input_listener_data {
     union {
         struct {
@@ -93,6 +136,10 @@ struct input_listener_data {
     int16_t h_wheel_remainder;
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAINS)
+    struct input_listener_chain chain;
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAINS)
+
     struct input_listener_processor_data base_processor_data;
     struct input_listener_processor_data layer_override_data[];
 };
@@ -153,6 +200,26 @@ static inline bool is_y_data(const struct input_event *evt) {
     return evt->type == INPUT_EV_REL && evt->code == INPUT_REL_Y;
 }
 
+static int16_t *remainder_for(struct input_processor_remainder_data *remainders, uint8_t type,
+                              uint16_t code) {
+    if (!remainders || type != INPUT_EV_REL) {
+        return NULL;
+    }
+
+    switch (code) {
+    case INPUT_REL_X:
+        return &remainders->x;
+    case INPUT_REL_Y:
+        return &remainders->y;
+    case INPUT_REL_WHEEL:
+        return &remainders->wheel;
+    case INPUT_REL_HWHEEL:
+        return &remainders->h_wheel;
+    default:
+        return NULL;
+    }
+}
+
 static int apply_config(uint8_t listener_index, const struct input_listener_config_entry *cfg,
                         struct input_listener_processor_data *processor_data,
                         struct input_listener_data *data, struct input_event *evt) {
@@ -164,25 +231,7 @@ static int apply_config(uint8_t listener_index, const struct input_listener_conf
             remainders = &processor_data->remainders[remainder_index++];
         }
 
-        int16_t *remainder = NULL;
-        if (remainders) {
-            if (evt->type == INPUT_EV_REL) {
-                switch (evt->code) {
-                case INPUT_REL_X:
-                    remainder = &remainders->x;
-                    break;
-                case INPUT_REL_Y:
-                    remainder = &remainders->y;
-                    break;
-                case INPUT_REL_WHEEL:
-                    remainder = &remainders->wheel;
-                    break;
-                case INPUT_REL_HWHEEL:
-                    remainder = &remainders->h_wheel;
-                    break;
-                }
-            }
-        }
+        int16_t *remainder = remainder_for(remainders, evt->type, evt->code);
 
         LOG_DBG("LISTENER INDEX: %d", listener_index);
         struct zmk_input_processor_state state = {.input_device_index = listener_index,
@@ -201,12 +250,242 @@ static int apply_config(uint8_t listener_index, const struct input_listener_conf
     return ZMK_INPUT_PROC_CONTINUE;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAINS)
+
+static void fuse_affine(struct input_listener_fused_code *fc,
+                        const struct zmk_input_processor_affine *affine, int16_t *remainder) {
+    bool pure_sign = affine->div == 1 && (affine->mul == 1 || affine->mul == -1);
+
+    if (!pure_sign) {
+        fc->mul *= affine->mul;
+        fc->div *= affine->div;
+        if (remainder) {
+            fc->remainder = remainder;
+        }
+    } else if (fc->mul == 1 && fc->div == 1) {
+        fc->sign_before *= affine->mul;
+    } else {
+        fc->sign_after *= affine->mul;
+    }
+
+    fc->code = affine->code;
+}
+
+// Add the processor to the step's fused codes, if it can describe itself as an affine step.
+static bool fuse_processor(struct input_listener_step *step,
+                           const struct zmk_input_processor_entry *proc_e,
+                           struct input_processor_remainder_data *remainders) {
+    struct zmk_input_processor_affine affines[ARRAY_SIZE(fused_codes)];
+
+    for (size_t c = 0; c < ARRAY_SIZE(fused_codes); c++) {
+        affines[c] = (struct zmk_input_processor_affine){
+            .code = step->fused_codes[c].code, .mul = 1, .div = 1};
+
+        int ret = zmk_input_processor_get_affine(proc_e->dev, INPUT_EV_REL, proc_e->param1,
+                                                 proc_e->param2, &affines[c]);
+        if (ret < 0 || affines[c].div == 0) {
+            return false;
+        }
+
+        // The carry is kept in the processors' 16-bit remainders, so the fused divisor has to fit
+        // in one. Past that, the processor starts a new step instead.
+        int64_t mul = (int64_t)step->fused_codes[c].mul * affines[c].mul;
+        int64_t div = (int64_t)step->fused_codes[c].div * affines[c].div;
+        if (mul > INT16_MAX || mul < -INT16_MAX || div > INT16_MAX || div < -INT16_MAX) {
+            return false;
+        }
+    }
+
+    for (size_t c = 0; c < ARRAY_SIZE(fused_codes); c++) {
+        struct input_listener_fused_code *fc = &step->fused_codes[c];
+        fuse_affine(fc, &affines[c],
+                    proc_e->track_remainders ? remainder_for(remainders, INPUT_EV_REL, fc->code)
+                                             : NULL);
+    }
+
+    return true;
+}
+
+static int compile_config(struct input_listener_chain *chain,
+                          const struct input_listener_config_entry *cfg,
+                          struct input_listener_processor_data *processor_data,
+                          bool stop_propagates) {
+    uint8_t first_step = chain->steps_len;
+    size_t remainder_index = 0;
+    size_t p = 0;
+
+    while (p < cfg->processors_len) {
+        if (chain->steps_len >= ARRAY_SIZE(chain->steps)) {
+            return -ENOMEM;
+        }
+
+        struct input_listener_step *step = &chain->steps[chain->steps_len++];
+        *step = (struct input_listener_step){
+            .processors = &cfg->processors[p],
+            .remainders =
+                processor_data->remainders ? &processor_data->remainders[remainder_index] : NULL,
+            .stop_propagates = stop_propagates,
+        };
+
+        for (size_t c = 0; c < ARRAY_SIZE(fused_codes); c++) {
+            step->fused_codes[c] = (struct input_listener_fused_code){
+                .code = fused_codes[c], .sign_before = 1, .sign_after = 1, .mul = 1, .div = 1};
+        }
+
+        while (p < cfg->processors_len &&
+               fuse_processor(step, &cfg->processors[p],
+                              step->remainders ? &processor_data->remainders[remainder_index]
+                                               : NULL)) {
+            step->fused = true;
+            step->processors_len++;
+            remainder_index += cfg->processors[p].track_remainders;
+            p++;
+        }
+
+        if (!step->fused) {
+            step->processors_len = 1;
+            remainder_index += cfg->processors[p].track_remainders;
+            p++;
+        }
+    }
+
+    for (uint8_t i = first_step; i < chain->steps_len; i++) {
+        chain->steps[i].segment_end = chain->steps_len;
+    }
+
+    return 0;
+}
+
+// Resolve the layer overrides the same way filter_with_input_config() below does, once per layer
+// state, into a flat list of steps.
+static int compile_chain(const struct input_listener_config *cfg,
+                         struct input_listener_data *data) {
+    struct input_listener_chain *chain = &data->chain;
+    chain->steps_len = 0;
+
+    for (size_t oi = 0; oi < cfg->layer_overrides_len; oi++) {
+        const struct input_listener_layer_override *override = &cfg->layer_overrides[oi];
+        uint32_t mask = override->layer_mask;
+        uint8_t layer = 0;
+        while (mask != 0) {
+            if (mask & BIT(0) && zmk_keymap_layer_active(layer)) {
+                int ret = compile_config(chain, &override->config, &data->layer_override_data[oi],
+                                         false);
+                if (ret < 0) {
+                    return ret;
+                }
+                if (!override->process_next) {
+                    return 0;
+                }
+            }
+
+            layer++;
+            mask = mask >> 1;
+        }
+    }
+
+    return compile_config(chain, &cfg->base, &data->base_processor_data, true);
+}
+
+static bool apply_fused(const struct input_listener_step *step, struct input_event *evt) {
+    if (evt->type != INPUT_EV_REL) {
+        return false;
+    }
+
+    for (size_t c = 0; c < ARRAY_SIZE(fused_codes); c++) {
+        if (fused_codes[c] != evt->code) {
+            continue;
+        }
+
+        const struct input_listener_fused_code *fc = &step->fused_codes[c];
+        int32_t value = evt->value * fc->sign_before * fc->mul;
+        if (fc->remainder) {
+            value += *fc->remainder;
+        }
+
+        int32_t scaled = value / fc->div;
+        if (fc->remainder) {
+            *fc->remainder = value - (scaled * fc->div);
+        }
+
+        evt->code = fc->code;
+        evt->value = scaled * fc->sign_after;
+        return true;
+    }
+
+    return false;
+}
+
+static int apply_step_processors(uint8_t listener_index, const struct input_listener_step *step,
+                                 struct input_event *evt) {
+    struct input_processor_remainder_data *remainders = step->remainders;
+
+    for (uint8_t p = 0; p < step->processors_len; p++) {
+        const struct zmk_input_processor_entry *proc_e = &step->processors[p];
+        int16_t *remainder = NULL;
+        if (proc_e->track_remainders) {
+            remainder = remainder_for(remainders++, evt->type, evt->code);
+        }
+
+        struct zmk_input_processor_state state = {.input_device_index = listener_index,
+                                                  .remainder = remainder};
+
+        int ret = zmk_input_processor_handle_event(proc_e->dev, evt, proc_e->param1, proc_e->param2,
+                                                   &state);
+        if (ret != ZMK_INPUT_PROC_CONTINUE) {
+            return ret;
+        }
+    }
+
+    return ZMK_INPUT_PROC_CONTINUE;
+}
+
+static int apply_chain(uint8_t listener_index, const struct input_listener_chain *chain,
+                       struct input_event *evt) {
+    uint8_t i = 0;
+    while (i < chain->steps_len) {
+        const struct input_listener_step *step = &chain->steps[i];
+        if (step->fused && apply_fused(step, evt)) {
+            i++;
+            continue;
+        }
+
+        int ret = apply_step_processors(listener_index, step, evt);
+        if (ret < 0 || (ret != ZMK_INPUT_PROC_CONTINUE && step->stop_propagates)) {
+            return ret;
+        }
+
+        i = ret == ZMK_INPUT_PROC_CONTINUE ? i + 1 : step->segment_end;
+    }
+
+    return ZMK_INPUT_PROC_CONTINUE;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAINS)
+
 static int filter_with_input_config(const struct input_listener_config *cfg,
                                     struct input_listener_data *data, struct input_event *evt) {
     if (!evt->dev) {
         return -ENODEV;
     }
 
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAINS)
+    zmk_keymap_layers_state_t layer_state = zmk_keymap_layer_state();
+    if (!data->chain.compiled || data->chain.layer_state != layer_state) {
+        data->chain.compiled = true;
+        data->chain.layer_state = layer_state;
+        data->chain.too_long = compile_chain(cfg, data) < 0;
+        if (data->chain.too_long) {
+            LOG_WRN("Input listener %d needs more than %d steps, not using a compiled chain",
+                    cfg->listener_index, CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAIN_MAX_STEPS);
+        }
+    }
+
+    if (!data->chain.too_long) {
+        return apply_chain(cfg->listener_index, &data->chain, evt);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_COMPILED_CHAINS)
+
     for (size_t oi = 0; oi < cfg->layer_overrides_len; oi++) {
         const struct input_listener_layer_override *override = &cfg->layer_overrides[oi];
         struct input_listener_processor_data *override_data = &data->layer_override_data[oi];
@@ -263,6 +542,131 @@ static void apply_resolution_scaling(struct input_listener_data *data, struct in
 }
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 
+static void apply_buttons(struct input_listener_data *data) {
+    if (data->mouse.button_set != 0) {
+        for (int i = 0; i < ZMK_HID_MOUSE_NUM_BUTTONS; i++) {
+            if ((data->mouse.button_set & BIT(i)) != 0) {
+                zmk_hid_mouse_button_press(i);
+            }
+        }
+    }
+
+    if (data->mouse.button_clear != 0) {
+        for (int i = 0; i < ZMK_HID_MOUSE_NUM_BUTTONS; i++) {
+            if ((data->mouse.button_clear & BIT(i)) != 0) {
+                zmk_hid_mouse_button_release(i);
+            }
+        }
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_ACCUMULATE_REPORTS)
+
+// Motion and scroll summed since the last mouse report was sent. The HID mouse report is shared by
+// all listeners, so they share one accumulator too.
+struct mouse_report_accumulator {
+    int32_t x, y;
+    int32_t scroll_x, scroll_y;
+    bool has_movement;
+    bool has_scroll;
+    int64_t next_report_at;
+};
+
+static struct mouse_report_accumulator accumulator;
+static K_MUTEX_DEFINE(accumulator_lock);
+
+static int32_t report_interval_ms(void) {
+#if CONFIG_ZMK_INPUT_LISTENER_REPORT_INTERVAL_MS > 0
+    return CONFIG_ZMK_INPUT_LISTENER_REPORT_INTERVAL_MS;
+#else
+    switch (zmk_endpoints_selected().transport) {
+#if IS_ENABLED(CONFIG_ZMK_USB)
+    case ZMK_TRANSPORT_USB:
+        return CONFIG_USB_HID_POLL_INTERVAL_MS;
+#endif // IS_ENABLED(CONFIG_ZMK_USB)
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+    case ZMK_TRANSPORT_BLE:
+        return zmk_ble_active_profile_conn_interval_us() / USEC_PER_MSEC;
+#endif // IS_ENABLED(CONFIG_ZMK_BLE)
+    default:
+        return 0;
+    }
+#endif // CONFIG_ZMK_INPUT_LISTENER_REPORT_INTERVAL_MS > 0
+}
+
+static int16_t take_int16(int32_t *value) {
+    int16_t part = CLAMP(*value, INT16_MIN, INT16_MAX);
+    *value -= part;
+    return part;
+}
+
+// Deltas that don't fit in the report's int16 fields are split over as many reports as needed.
+static void send_accumulated_report(void) {
+    do {
+        if (accumulator.has_scroll) {
+            zmk_hid_mouse_scroll_set(take_int16(&accumulator.scroll_x),
+                                     take_int16(&accumulator.scroll_y));
+        }
+
+        if (accumulator.has_movement) {
+            zmk_hid_mouse_movement_set(take_int16(&accumulator.x), take_int16(&accumulator.y));
+        }
+
+        zmk_endpoints_send_mouse_report();
+        zmk_hid_mouse_scroll_set(0, 0);
+        zmk_hid_mouse_movement_set(0, 0);
+
+        accumulator.has_scroll = accumulator.scroll_x != 0 || accumulator.scroll_y != 0;
+        accumulator.has_movement = accumulator.x != 0 || accumulator.y != 0;
+    } while (accumulator.has_scroll || accumulator.has_movement);
+
+    accumulator.next_report_at = k_uptime_get() + report_interval_ms();
+}
+
+static void flush_timer_handler(struct zmk_timer *timer) {
+    k_mutex_lock(&accumulator_lock, K_FOREVER);
+
+    if (accumulator.has_scroll || accumulator.has_movement) {
+        send_accumulated_report();
+    }
+
+    k_mutex_unlock(&accumulator_lock);
+}
+
+static ZMK_TIMER_DEFINE(flush_timer, flush_timer_handler);
+
+static void accumulate_mouse_report(struct input_listener_data *data) {
+    k_mutex_lock(&accumulator_lock, K_FOREVER);
+
+    if (data->mouse.wheel_data.mode == INPUT_LISTENER_XY_DATA_MODE_REL) {
+        accumulator.scroll_x += data->mouse.wheel_data.x.value;
+        accumulator.scroll_y += data->mouse.wheel_data.y.value;
+        accumulator.has_scroll = true;
+    }
+
+    if (data->mouse.data.mode == INPUT_LISTENER_XY_DATA_MODE_REL) {
+        accumulator.x += data->mouse.data.x.value;
+        accumulator.y += data->mouse.data.y.value;
+        accumulator.has_movement = true;
+    }
+
+    bool buttons_changed = data->mouse.button_set != 0 || data->mouse.button_clear != 0;
+    apply_buttons(data);
+
+    // Button changes go out right away so clicks aren't delayed, and carry the motion before them.
+    if (buttons_changed || k_uptime_get() >= accumulator.next_report_at) {
+        zmk_timer_cancel(&flush_timer);
+        send_accumulated_report();
+    } else if ((accumulator.has_scroll || accumulator.has_movement) &&
+               !zmk_timer_is_pending(&flush_timer)) {
+        zmk_timer_start_at(&flush_timer, accumulator.next_report_at);
+    }
+
+    k_mutex_unlock(&accumulator_lock);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_ACCUMULATE_REPORTS)
+
 static void input_handler(const struct input_listener_config *config,
                           struct input_listener_data *data, struct input_event *evt) {
     // First, process to update the event data as needed.
@@ -292,6 +696,9 @@ static void input_handler(const struct input_listener_config *config,
     }
 
     if (evt->sync) {
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_ACCUMULATE_REPORTS)
+        accumulate_mouse_report(data);
+#else
         if (data->mouse.wheel_data.mode == INPUT_LISTENER_XY_DATA_MODE_REL) {
             zmk_hid_mouse_scroll_set(data->mouse.wheel_data.x.value,
                                      data->mouse.wheel_data.y.value);
@@ -301,25 +708,12 @@ static void input_handler(const struct input_listener_config *config,
             zmk_hid_mouse_movement_set(data->mouse.data.x.value, data->mouse.data.y.value);
         }
 
-        if (data->mouse.button_set != 0) {
-            for (int i = 0; i < ZMK_HID_MOUSE_NUM_BUTTONS; i++) {
-                if ((data->mouse.button_set & BIT(i)) != 0) {
-                    zmk_hid_mouse_button_press(i);
-                }
-            }
-        }
-
-        if (data->mouse.button_clear != 0) {
-            for (int i = 0; i < ZMK_HID_MOUSE_NUM_BUTTONS; i++) {
-                if ((data->mouse.button_clear & BIT(i)) != 0) {
-                    zmk_hid_mouse_button_release(i);
-                }
-            }
-        }
+        apply_buttons(data);
 
         zmk_endpoints_send_mouse_report();
         zmk_hid_mouse_scroll_set(0, 0);
         zmk_hid_mouse_movement_set(0, 0);
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_ACCUMULATE_REPORTS)
 
         clear_xy_data(&data->mouse.data);
         clear_xy_data(&data->mouse.wheel_data);
@@ -40,8 +40,19 @@ static int cm_handle_event(const struct device *dev, struct input_event *event,
     return ZMK_INPUT_PROC_CONTINUE;
 }
 
+static int cm_get_affine(const struct device *dev, uint8_t type, uint32_t param1, uint32_t param2,
+                         struct zmk_input_processor_affine *affine) {
+    struct input_event event = {.type = type, .code = affine->code};
+
+    cm_handle_event(dev, &event, param1, param2, NULL);
+
+    affine->code = event.code;
+    return 0;
+}
+
 static struct zmk_input_processor_driver_api cm_driver_api = {
     .handle_event = cm_handle_event,
+    .get_affine = cm_get_affine,
 };
 
 #define TL_INST(n)                                                                                 \
@@ -59,8 +59,28 @@ static int scaler_handle_event(const struct device *dev, struct input_event *eve
     return ZMK_INPUT_PROC_CONTINUE;
 }
 
+static int scaler_get_affine(const struct device *dev, uint8_t type, uint32_t param1,
+                             uint32_t param2, struct zmk_input_processor_affine *affine) {
+    const struct scaler_config *cfg = dev->config;
+
+    if (type != cfg->type) {
+        return 0;
+    }
+
+    for (int i = 0; i < cfg->codes_len; i++) {
+        if (cfg->codes[i] == affine->code) {
+            affine->mul = (int16_t)param1;
+            affine->div = (int16_t)param2;
+            break;
+        }
+    }
+
+    return 0;
+}
+
 static struct zmk_input_processor_driver_api scaler_driver_api = {
     .handle_event = scaler_handle_event,
+    .get_affine = scaler_get_affine,
 };
 
 #define SCALER_INST(n)                                                                             \
@@ -12,6 +12,7 @@
 #include <zephyr/logging/log.h>
 #include <zmk/keymap.h>
 #include <zmk/behavior.h>
+#include <zmk/timer.h>
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/keycode_state_changed.h>
 #include <zmk/events/layer_state_changed.h>
@@ -39,8 +40,8 @@ struct temp_layer_data {
     struct temp_layer_state state;
 };
 
-/* Static Work Queue Items */
-static struct k_work_delayable layer_disable_works[MAX_LAYERS];
+/* Static Timers */
+static struct zmk_timer layer_disable_timers[MAX_LAYERS];
 
 /* Position Search */
 static bool position_is_excluded(const struct temp_layer_config *config, uint32_t position) {
@@ -116,10 +117,9 @@ static void layer_action_work_cb(struct k_work *work) {
 
 static K_WORK_DEFINE(layer_action_work, layer_action_work_cb);
 
-/* Work Queue Callback */
-static void layer_disable_callback(struct k_work *work) {
-    struct k_work_delayable *d_work = k_work_delayable_from_work(work);
-    int layer_index = ARRAY_INDEX(layer_disable_works, d_work);
+/* Timer Callback */
+static void layer_disable_callback(struct zmk_timer *timer) {
+    int layer_index = ARRAY_INDEX(layer_disable_timers, timer);
 
     struct layer_state_action action = {.layer = layer_index, .activate = false};
 
@@ -137,7 +137,7 @@ static int handle_layer_state_changed(const struct device *dev, const zmk_event_
     if (!zmk_keymap_layer_active(zmk_keymap_layer_index_to_id(data->state.toggle_layer))) {
         LOG_DBG("Deactivating layer that was activated by this processor");
         data->state.is_active = false;
-        k_work_cancel_delayable(&layer_disable_works[data->state.toggle_layer]);
+        zmk_timer_cancel(&layer_disable_timers[data->state.toggle_layer]);
     }
     ret = k_mutex_unlock(&data->lock);
     if (ret < 0) {
@@ -256,7 +256,7 @@ static int temp_layer_handle_event(const struct device *dev, struct input_event
     }
 
     if (param2 > 0) {
-        k_work_reschedule(&layer_disable_works[param1], K_MSEC(param2));
+        zmk_timer_start(&layer_disable_timers[param1], param2);
     }
 
     k_mutex_unlock(&data->lock);
@@ -269,7 +269,7 @@ static int temp_layer_init(const struct device *dev) {
     k_mutex_init(&data->lock);
 
     for (int i = 0; i < MAX_LAYERS; i++) {
-        k_work_init_delayable(&layer_disable_works[i], layer_disable_callback);
+        zmk_timer_init(&layer_disable_timers[i], layer_disable_callback);
     }
 
     return 0;
@@ -68,8 +68,20 @@ static int ipt_handle_event(const struct device *dev, struct input_event *event,
     return ZMK_INPUT_PROC_CONTINUE;
 }
 
+static int ipt_get_affine(const struct device *dev, uint8_t type, uint32_t param1, uint32_t param2,
+                          struct zmk_input_processor_affine *affine) {
+    struct input_event event = {.type = type, .code = affine->code, .value = 1};
+
+    ipt_handle_event(dev, &event, param1, param2, NULL);
+
+    affine->code = event.code;
+    affine->mul = event.value;
+    return 0;
+}
+
 static struct zmk_input_processor_driver_api ipt_driver_api = {
     .handle_event = ipt_handle_event,
+    .get_affine = ipt_get_affine,
 };
 
 static int ipt_init(const struct device *dev) { return 0; }
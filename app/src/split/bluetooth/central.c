@@ -26,6 +26,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/split/transport/central.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
+#include <zmk/split/bluetooth/central.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/sensor_event.h>
@@ -38,6 +39,9 @@ static int start_scanning(void);
 
 #define POSITION_STATE_DATA_LEN 16
 
+// The position events stream can report any 8-bit position, unlike the position state bitmap
+#define POSITION_STATE_TRACKED_LEN (BIT(8) / 8)
+
 enum peripheral_slot_state {
     PERIPHERAL_SLOT_STATE_OPEN,
     PERIPHERAL_SLOT_STATE_CONNECTING,
@@ -49,9 +53,16 @@ struct peripheral_slot {
     struct bt_conn *conn;
     struct bt_gatt_discover_params discover_params;
     struct bt_gatt_subscribe_params subscribe_params;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+    struct bt_gatt_subscribe_params position_events_subscribe_params;
+    int64_t last_position_event_timestamp;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
     struct bt_gatt_subscribe_params sensor_subscribe_params;
     struct bt_gatt_discover_params sub_discover_params;
     uint16_t run_behavior_handle;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+    uint16_t run_behavior_by_local_id_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
     struct bt_gatt_subscribe_params batt_lvl_subscribe_params;
     struct bt_gatt_read_params batt_lvl_read_params;
@@ -60,7 +71,7 @@ struct peripheral_slot {
     uint16_t update_hid_indicators;
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
     uint16_t selected_physical_layout_handle;
-    uint8_t position_state[POSITION_STATE_DATA_LEN];
+    uint8_t position_state[POSITION_STATE_TRACKED_LEN];
     uint8_t changed_positions[POSITION_STATE_DATA_LEN];
 };
 
@@ -140,6 +151,11 @@ static const struct bt_uuid_128 split_service_uuid = BT_UUID_INIT_128(ZMK_SPLIT_
 
 struct peripheral_event_wrapper {
     uint8_t source;
+    int64_t timestamp;
+#if CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS > 0
+    // When the central started holding the event for reordering
+    int64_t arrival;
+#endif // CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS > 0
     struct zmk_split_transport_peripheral_event event;
 };
 
@@ -189,12 +205,13 @@ int release_peripheral_slot(int index) {
     slot->state = PERIPHERAL_SLOT_STATE_OPEN;
 
     // Raise events releasing any active positions from this peripheral
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
+    for (int i = 0; i < POSITION_STATE_TRACKED_LEN; i++) {
         for (int j = 0; j < 8; j++) {
             if (slot->position_state[i] & BIT(j)) {
                 uint32_t position = (i * 8) + j;
                 struct peripheral_event_wrapper ev = {
                     .source = index,
+                    .timestamp = k_uptime_get(),
                     .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
                               .data = {.key_position_event = {
                                            .position = position,
@@ -207,14 +224,19 @@ int release_peripheral_slot(int index) {
         }
     }
 
-    for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        slot->position_state[i] = 0U;
-        slot->changed_positions[i] = 0U;
-    }
+    memset(slot->position_state, 0, sizeof(slot->position_state));
+    memset(slot->changed_positions, 0, sizeof(slot->changed_positions));
 
     // Clean up previously discovered handles;
     slot->subscribe_params.value_handle = 0;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+    slot->position_events_subscribe_params.value_handle = 0;
+    slot->last_position_event_timestamp = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
     slot->run_behavior_handle = 0;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+    slot->run_behavior_by_local_id_handle = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
     slot->selected_physical_layout_handle = 0;
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
     slot->update_hid_indicators = 0;
@@ -288,6 +310,7 @@ static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
 
     struct peripheral_event_wrapper event_wrapper = {
         .source = peripheral_slot_index_for_conn(conn),
+        .timestamp = k_uptime_get(),
         .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT,
                   .data = {.sensor_event = {
                                .channel_data = sensor_event.channel_data[0],
@@ -377,6 +400,7 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
                 bool pressed = slot->position_state[i] & BIT(j);
                 struct peripheral_event_wrapper ev = {
                     .source = peripheral_slot_index_for_conn(conn),
+                    .timestamp = k_uptime_get(),
                     .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
                               .data = {.key_position_event = {
                                            .position = position,
@@ -391,6 +415,85 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
     return BT_GATT_ITER_CONTINUE;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+
+static uint8_t split_central_position_events_notify_func(struct bt_conn *conn,
+                                                         struct bt_gatt_subscribe_params *params,
+                                                         const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+
+    if (slot == NULL) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    if (!data) {
+        LOG_DBG("[UNSUBSCRIBED]");
+        params->value_handle = 0U;
+        return BT_GATT_ITER_STOP;
+    }
+
+    LOG_DBG("[POSITION EVENTS NOTIFICATION] data %p length %u", data, length);
+
+    struct zmk_split_position_events_header header;
+    if (length < sizeof(header)) {
+        LOG_WRN("Ignoring position events notify with insufficient data length (%d)", length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    if (header.version != ZMK_SPLIT_POSITION_EVENTS_VERSION) {
+        LOG_WRN("Ignoring position events with unsupported version %d", header.version);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    const struct zmk_split_position_event_record *records =
+        (const struct zmk_split_position_event_record *)((const uint8_t *)data + sizeof(header));
+    size_t count = MIN(header.count, (length - sizeof(header)) / sizeof(records[0]));
+
+    // Work back from the last record, which happened `age` ms before the notification was
+    // sent, to find when the first record happened.
+    int64_t timestamp = k_uptime_get() - sys_le16_to_cpu(header.age);
+    for (int i = count - 1; i > 0; i--) {
+        timestamp -=
+            sys_le16_to_cpu(records[i].state_delta) & ZMK_SPLIT_POSITION_EVENT_DELTA_MAX;
+    }
+
+    int source = peripheral_slot_index_for_conn(conn);
+
+    for (int i = 0; i < count; i++) {
+        uint16_t state_delta = sys_le16_to_cpu(records[i].state_delta);
+        uint8_t position = records[i].position;
+        bool pressed = state_delta & ZMK_SPLIT_POSITION_EVENT_PRESSED;
+
+        if (i > 0) {
+            timestamp += state_delta & ZMK_SPLIT_POSITION_EVENT_DELTA_MAX;
+        }
+
+        // Notifications can arrive with varying delays, so never go back in time relative to
+        // the previous batch.
+        slot->last_position_event_timestamp = MAX(timestamp, slot->last_position_event_timestamp);
+
+        WRITE_BIT(slot->position_state[position / 8], position % 8, pressed);
+
+        struct peripheral_event_wrapper ev = {
+            .source = source,
+            .timestamp = slot->last_position_event_timestamp,
+            .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+                      .data = {.key_position_event = {
+                                   .position = position,
+                                   .pressed = pressed,
+                               }}}};
+        k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
+    }
+
+    k_work_submit(&peripheral_event_work);
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
 
 static uint8_t split_central_battery_level_notify_func(struct bt_conn *conn,
@@ -568,6 +671,22 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
             slot->subscribe_params.notify = split_central_notify_func;
             slot->subscribe_params.value = BT_GATT_CCC_NOTIFY;
             split_central_subscribe(conn, &slot->subscribe_params);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+        } else if (bt_uuid_cmp(chrc_uuid,
+                               BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_EVENTS_UUID)) == 0) {
+            // Peripherals that support this stop notifying the position state once we subscribe,
+            // and older ones never have this characteristic, so we keep using the position state.
+            LOG_DBG("Found position events characteristic");
+            slot->position_events_subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
+            // The CCC directly follows the value, so skip discovering it while the position
+            // state subscription may still be using the shared discover params.
+            slot->position_events_subscribe_params.ccc_handle =
+                slot->position_events_subscribe_params.value_handle + 1;
+            slot->position_events_subscribe_params.notify =
+                split_central_position_events_notify_func;
+            slot->position_events_subscribe_params.value = BT_GATT_CCC_NOTIFY;
+            split_central_subscribe(conn, &slot->position_events_subscribe_params);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
 #if ZMK_KEYMAP_HAS_SENSORS
         } else if (bt_uuid_cmp(chrc_uuid,
                                BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_SENSOR_STATE_UUID)) == 0) {
@@ -609,6 +728,15 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
             slot->discover_params.uuid = NULL;
             slot->discover_params.start_handle = attr->handle + 2;
             slot->run_behavior_handle = bt_gatt_attr_value_handle(attr);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+        } else if (bt_uuid_cmp(chrc_uuid, BT_UUID_DECLARE_128(
+                                              ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_BY_LOCAL_ID_UUID)) ==
+                   0) {
+            LOG_DBG("Found run behavior by local ID handle");
+            slot->discover_params.uuid = NULL;
+            slot->discover_params.start_handle = attr->handle + 2;
+            slot->run_behavior_by_local_id_handle = bt_gatt_attr_value_handle(attr);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
         } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                                 BT_UUID_DECLARE_128(ZMK_SPLIT_BT_SELECT_PHYS_LAYOUT_UUID))) {
             LOG_DBG("Found select physical layout handle");
@@ -695,6 +823,11 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
     subscribed = subscribed && slot->update_hid_indicators;
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+    // Peripherals running older firmware don't have this characteristic, in which case
+    // discovery simply runs to completion and behaviors are invoked by name.
+    subscribed = subscribed && slot->run_behavior_by_local_id_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
     subscribed = subscribed && slot->batt_lvl_subscribe_params.value_handle;
 #endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
@@ -814,9 +947,13 @@ static bool split_central_eir_found(const bt_addr_le_t *addr) {
     }
 
     LOG_DBG("Initiating new connection");
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CONN_PARAM_PROFILES)
+    const struct bt_le_conn_param *param = zmk_split_bt_central_conn_param();
+#else
     struct bt_le_conn_param *param =
         BT_LE_CONN_PARAM(CONFIG_ZMK_SPLIT_BLE_PREF_INT, CONFIG_ZMK_SPLIT_BLE_PREF_INT,
                          CONFIG_ZMK_SPLIT_BLE_PREF_LATENCY, CONFIG_ZMK_SPLIT_BLE_PREF_TIMEOUT);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CONN_PARAM_PROFILES)
     err = bt_conn_le_create(addr, BT_CONN_LE_CREATE_CONN, param, &slot->conn);
     if (err < 0) {
         LOG_ERR("Create conn failed (err %d) (create conn? 0x%04x)", err, BT_HCI_OP_LE_CREATE_CONN);
@@ -1026,6 +1163,63 @@ struct central_cmd_wrapper {
 K_MSGQ_DEFINE(zmk_split_central_split_run_msgq, sizeof(struct central_cmd_wrapper),
               CONFIG_ZMK_SPLIT_BLE_CENTRAL_SPLIT_RUN_QUEUE_SIZE, 4);
 
+static int write_run_behavior_by_name(struct peripheral_slot *slot,
+                                      const struct zmk_split_run_behavior_data *data,
+                                      const char *behavior_dev) {
+    if (!slot->run_behavior_handle) {
+        LOG_ERR("Run behavior handle not found");
+        return -ENODEV;
+    }
+
+    struct zmk_split_run_behavior_payload payload = {.data = *data};
+    const size_t payload_dev_size = sizeof(payload.behavior_dev);
+    if (strlcpy(payload.behavior_dev, behavior_dev, payload_dev_size) >= payload_dev_size) {
+        LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
+                behavior_dev, payload.behavior_dev);
+    }
+
+    int err = bt_gatt_write_without_response(slot->conn, slot->run_behavior_handle, &payload,
+                                             sizeof(struct zmk_split_run_behavior_payload), true);
+
+    if (err) {
+        LOG_ERR("Failed to write the behavior characteristic (err %d)", err);
+    }
+
+    return err;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+
+static int write_run_behavior_by_local_id(struct peripheral_slot *slot,
+                                          const struct zmk_split_run_behavior_data *data,
+                                          zmk_behavior_local_id_t local_id) {
+    if (!slot->run_behavior_by_local_id_handle) {
+        const char *behavior_dev = zmk_behavior_find_behavior_name_from_local_id(local_id);
+        if (!behavior_dev) {
+            LOG_ERR("No behavior with local ID %d", local_id);
+            return -ENODEV;
+        }
+
+        return write_run_behavior_by_name(slot, data, behavior_dev);
+    }
+
+    struct zmk_split_run_behavior_by_local_id_payload payload = {
+        .data = *data,
+        .local_id = local_id,
+    };
+
+    int err = bt_gatt_write_without_response(slot->conn, slot->run_behavior_by_local_id_handle,
+                                             &payload, sizeof(payload), true);
+
+    if (err) {
+        LOG_ERR("Failed to write the behavior by local ID characteristic (err %d)", err);
+    }
+
+    return err;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+
 void split_central_split_run_callback(struct k_work *work) {
     struct central_cmd_wrapper payload_wrapper;
 
@@ -1039,37 +1233,34 @@ void split_central_split_run_callback(struct k_work *work) {
 
         switch (payload_wrapper.cmd.type) {
         case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR: {
-            if (!peripherals[payload_wrapper.source].run_behavior_handle) {
-                LOG_ERR("Run behavior handle not found");
-                continue;
-            }
-
-            struct zmk_split_run_behavior_payload payload = {
-                .data = {
-                    .param1 = payload_wrapper.cmd.data.invoke_behavior.param1,
-                    .param2 = payload_wrapper.cmd.data.invoke_behavior.param2,
-                    .position = payload_wrapper.cmd.data.invoke_behavior.position,
-                    .source = payload_wrapper.cmd.data.invoke_behavior.event_source,
-                    .state = payload_wrapper.cmd.data.invoke_behavior.state ? 1 : 0,
-                }};
-            const size_t payload_dev_size = sizeof(payload.behavior_dev);
-            if (strlcpy(payload.behavior_dev, payload_wrapper.cmd.data.invoke_behavior.behavior_dev,
-                        payload_dev_size) >= payload_dev_size) {
-                LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
-                        payload_wrapper.cmd.data.invoke_behavior.behavior_dev,
-                        payload.behavior_dev);
-            }
-
-            int err = bt_gatt_write_without_response(
-                peripherals[payload_wrapper.source].conn,
-                peripherals[payload_wrapper.source].run_behavior_handle, &payload,
-                sizeof(struct zmk_split_run_behavior_payload), true);
-
-            if (err) {
-                LOG_ERR("Failed to write the behavior characteristic (err %d)", err);
-            }
+            struct zmk_split_run_behavior_data data = {
+                .param1 = payload_wrapper.cmd.data.invoke_behavior.param1,
+                .param2 = payload_wrapper.cmd.data.invoke_behavior.param2,
+                .position = payload_wrapper.cmd.data.invoke_behavior.position,
+                .source = payload_wrapper.cmd.data.invoke_behavior.event_source,
+                .state = payload_wrapper.cmd.data.invoke_behavior.state ? 1 : 0,
+            };
+
+            write_run_behavior_by_name(&peripherals[payload_wrapper.source], &data,
+                                       payload_wrapper.cmd.data.invoke_behavior.behavior_dev);
             break;
         }
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+        case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR_BY_LOCAL_ID: {
+            struct zmk_split_run_behavior_data data = {
+                .param1 = payload_wrapper.cmd.data.invoke_behavior_by_local_id.param1,
+                .param2 = payload_wrapper.cmd.data.invoke_behavior_by_local_id.param2,
+                .position = payload_wrapper.cmd.data.invoke_behavior_by_local_id.position,
+                .source = payload_wrapper.cmd.data.invoke_behavior_by_local_id.event_source,
+                .state = payload_wrapper.cmd.data.invoke_behavior_by_local_id.state ? 1 : 0,
+            };
+
+            write_run_behavior_by_local_id(
+                &peripherals[payload_wrapper.source], &data,
+                payload_wrapper.cmd.data.invoke_behavior_by_local_id.local_id);
+            break;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
         case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
             update_peripheral_selected_layout(
                 &peripherals[payload_wrapper.source],
@@ -1180,7 +1371,8 @@ static int split_central_bt_send_command(uint8_t source,
     switch (cmd.type) {
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS:
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
-    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR: {
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR:
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR_BY_LOCAL_ID: {
         struct central_cmd_wrapper wrapper = {.source = source, .cmd = cmd};
         return split_bt_invoke_behavior_payload(wrapper);
     }
@@ -1285,11 +1477,172 @@ static int finish_init() {
     return transport_status_cb(&bt_central, split_central_bt_get_status());
 }
 
+static void raise_peripheral_event(const struct peripheral_event_wrapper *ev) {
+    LOG_DBG("Trigger key position state change for %d", ev->event.data.key_position_event.position);
+    zmk_split_transport_central_peripheral_event_handler_at(&bt_central, ev->source, ev->event,
+                                                            ev->timestamp);
+}
+
+#if CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS > 0
+
+/*
+ * Timestamped events from all peripherals are merged by their capture time. The oldest buffered
+ * event is raised once every other connected peripheral has a buffered event at least as recent,
+ * since each peripheral's own events always arrive in order, or once it has been held for the
+ * reorder window, whichever comes first. The window counts from arrival rather than capture, since
+ * every event spends at least a connection interval in transit. With a single peripheral
+ * connected, events aren't delayed at all.
+ */
+#define REORDER_BUFFER_SIZE                                                                        \
+    (CONFIG_ZMK_SPLIT_BLE_CENTRAL_POSITION_QUEUE_SIZE * ZMK_SPLIT_BLE_PERIPHERAL_COUNT)
+
+static struct peripheral_event_wrapper reorder_buffer[REORDER_BUFFER_SIZE];
+static size_t reorder_buffer_len;
+static int64_t last_released_timestamp;
+
+static struct zmk_split_bt_central_source_stats source_stats[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+static int64_t last_transit[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+// Jitter in 1/16ms, so the RFC 3550 estimator can be updated with integer math
+static uint32_t jitter_q4[ZMK_SPLIT_BLE_PERIPHERAL_COUNT];
+
+K_WORK_DELAYABLE_DEFINE(peripheral_event_reorder_work, peripheral_event_work_callback);
+
+int zmk_split_bt_central_get_source_stats(uint8_t source,
+                                          struct zmk_split_bt_central_source_stats *stats) {
+    if (source >= ZMK_SPLIT_BLE_PERIPHERAL_COUNT) {
+        return -EINVAL;
+    }
+
+    *stats = source_stats[source];
+    return 0;
+}
+
+static bool is_reorderable_event(const struct peripheral_event_wrapper *ev) {
+    switch (ev->event.type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
+        return ev->source < ZMK_SPLIT_BLE_PERIPHERAL_COUNT;
+    default:
+        return false;
+    }
+}
+
+static void record_transit(const struct peripheral_event_wrapper *ev) {
+    struct zmk_split_bt_central_source_stats *stats = &source_stats[ev->source];
+    int64_t transit = k_uptime_get() - ev->timestamp;
+
+    if (stats->events > 0) {
+        int64_t delta = transit - last_transit[ev->source];
+        jitter_q4[ev->source] += (uint32_t)MIN(delta < 0 ? -delta : delta, UINT16_MAX);
+        jitter_q4[ev->source] -= (jitter_q4[ev->source] + 8) / 16;
+        stats->jitter_ms = jitter_q4[ev->source] / 16;
+    }
+
+    last_transit[ev->source] = transit;
+    stats->max_transit_ms = MAX(stats->max_transit_ms, (uint16_t)CLAMP(transit, 0, UINT16_MAX));
+    stats->events++;
+
+    if (ev->timestamp < last_released_timestamp) {
+        stats->late++;
+    }
+}
+
+static void release_oldest_event(void) {
+    struct peripheral_event_wrapper ev = reorder_buffer[0];
+
+    reorder_buffer_len--;
+    memmove(&reorder_buffer[0], &reorder_buffer[1], reorder_buffer_len * sizeof(reorder_buffer[0]));
+    last_released_timestamp = MAX(last_released_timestamp, ev.timestamp);
+
+    raise_peripheral_event(&ev);
+}
+
+static void buffer_event(const struct peripheral_event_wrapper *ev) {
+    if (reorder_buffer_len == REORDER_BUFFER_SIZE) {
+        release_oldest_event();
+    }
+
+    // Keep arrival order for events with the same timestamp
+    size_t idx = reorder_buffer_len;
+    while (idx > 0 && reorder_buffer[idx - 1].timestamp > ev->timestamp) {
+        idx--;
+    }
+
+    for (size_t i = idx; i < reorder_buffer_len; i++) {
+        if (reorder_buffer[i].source != ev->source) {
+            source_stats[ev->source].reordered++;
+            break;
+        }
+    }
+
+    memmove(&reorder_buffer[idx + 1], &reorder_buffer[idx],
+            (reorder_buffer_len - idx) * sizeof(reorder_buffer[0]));
+    reorder_buffer[idx] = *ev;
+    reorder_buffer_len++;
+}
+
+static bool other_sources_caught_up(uint8_t source) {
+    for (uint8_t i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
+        if (i == source || peripherals[i].state != PERIPHERAL_SLOT_STATE_CONNECTED) {
+            continue;
+        }
+
+        bool pending = false;
+        for (size_t j = 0; j < reorder_buffer_len; j++) {
+            if (reorder_buffer[j].source == i) {
+                pending = true;
+                break;
+            }
+        }
+
+        if (!pending) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void release_ordered_events(void) {
+    while (reorder_buffer_len > 0) {
+        int64_t held = k_uptime_get() - reorder_buffer[0].arrival;
+
+        if (held < CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS &&
+            !other_sources_caught_up(reorder_buffer[0].source)) {
+            k_work_reschedule(&peripheral_event_reorder_work,
+                              K_MSEC(CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS - held));
+            return;
+        }
+
+        release_oldest_event();
+    }
+}
+
+#else
+
+int zmk_split_bt_central_get_source_stats(uint8_t source,
+                                          struct zmk_split_bt_central_source_stats *stats) {
+    return -ENOTSUP;
+}
+
+#endif // CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS > 0
+
 void peripheral_event_work_callback(struct k_work *work) {
     struct peripheral_event_wrapper ev;
     while (k_msgq_get(&peripheral_event_msgq, &ev, K_NO_WAIT) == 0) {
-        LOG_DBG("Trigger key position state change for %d",
-                ev.event.data.key_position_event.position);
-        zmk_split_transport_central_peripheral_event_handler(&bt_central, ev.source, ev.event);
+#if CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS > 0
+        if (is_reorderable_event(&ev)) {
+            ev.arrival = k_uptime_get();
+            record_transit(&ev);
+            buffer_event(&ev);
+            continue;
+        }
+#endif // CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS > 0
+
+        raise_peripheral_event(&ev);
     }
+
+#if CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS > 0
+    release_ordered_events();
+#endif // CONFIG_ZMK_SPLIT_BLE_CENTRAL_REORDER_WINDOW_MS > 0
 }
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2025 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/bluetooth/conn.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/event_manager.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/split/bluetooth/central.h>
+
+static const struct bt_le_conn_param conn_param_profiles[] = {
+    [ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_LATENCY] =
+        BT_LE_CONN_PARAM_INIT(CONFIG_ZMK_SPLIT_BLE_PREF_INT, CONFIG_ZMK_SPLIT_BLE_PREF_INT,
+                              CONFIG_ZMK_SPLIT_BLE_PREF_LATENCY, CONFIG_ZMK_SPLIT_BLE_PREF_TIMEOUT),
+    [ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_POWER] = BT_LE_CONN_PARAM_INIT(
+        CONFIG_ZMK_SPLIT_BLE_LOW_POWER_INT, CONFIG_ZMK_SPLIT_BLE_LOW_POWER_INT,
+        CONFIG_ZMK_SPLIT_BLE_LOW_POWER_LATENCY, CONFIG_ZMK_SPLIT_BLE_LOW_POWER_TIMEOUT),
+};
+
+static enum zmk_split_bt_conn_param_profile target_profile =
+    ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_LATENCY;
+static int64_t last_update_timestamp;
+static bool update_deferred;
+
+static struct zmk_split_bt_conn_param_stats stats = {
+    .profile = ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_LATENCY,
+};
+
+const struct bt_le_conn_param *zmk_split_bt_central_conn_param(void) {
+    return &conn_param_profiles[stats.profile];
+}
+
+enum zmk_split_bt_conn_param_profile zmk_split_bt_central_get_conn_param_profile(void) {
+    return stats.profile;
+}
+
+void zmk_split_bt_central_get_conn_param_stats(struct zmk_split_bt_conn_param_stats *out) {
+    *out = stats;
+}
+
+static bool is_split_conn(struct bt_conn *conn) {
+    struct bt_conn_info info;
+
+    // The split central is the central for its peripherals, and the peripheral for its hosts.
+    return bt_conn_get_info(conn, &info) == 0 && info.role == BT_CONN_ROLE_CENTRAL &&
+           info.state == BT_CONN_STATE_CONNECTED;
+}
+
+static void update_conn_params(struct bt_conn *conn, void *data) {
+    if (!is_split_conn(conn)) {
+        return;
+    }
+
+    int err = bt_conn_le_param_update(conn, zmk_split_bt_central_conn_param());
+    if (err < 0) {
+        LOG_WRN("Failed to update split connection parameters (err %d)", err);
+        stats.update_failures++;
+    }
+}
+
+static void apply_conn_param_profile(struct k_work *work) {
+    if (target_profile == stats.profile) {
+        return;
+    }
+
+    int64_t since_last_update = k_uptime_get() - last_update_timestamp;
+    if (last_update_timestamp &&
+        since_last_update < CONFIG_ZMK_SPLIT_BLE_CONN_PARAM_MIN_UPDATE_INTERVAL_MS) {
+        if (!update_deferred) {
+            update_deferred = true;
+            stats.deferred++;
+        }
+
+        k_work_schedule(k_work_delayable_from_work(work),
+                        K_MSEC(CONFIG_ZMK_SPLIT_BLE_CONN_PARAM_MIN_UPDATE_INTERVAL_MS -
+                               since_last_update));
+        return;
+    }
+
+    LOG_DBG("Switching split connections to the %s profile",
+            target_profile == ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_POWER ? "low power"
+                                                                         : "low latency");
+
+    update_deferred = false;
+    last_update_timestamp = k_uptime_get();
+    stats.profile = target_profile;
+    stats.switches++;
+
+    bt_conn_foreach(BT_CONN_TYPE_LE, update_conn_params, NULL);
+}
+
+K_WORK_DELAYABLE_DEFINE(conn_param_work, apply_conn_param_profile);
+
+static void conn_params_le_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+                                         uint16_t timeout) {
+    if (!is_split_conn(conn)) {
+        return;
+    }
+
+    LOG_DBG("Split connection parameters updated: interval %d latency %d timeout %d", interval,
+            latency, timeout);
+    stats.interval = interval;
+}
+
+static struct bt_conn_cb conn_callbacks = {
+    .le_param_updated = conn_params_le_param_updated,
+};
+
+static int conn_params_listener(const zmk_event_t *eh) {
+    struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+    if (ev == NULL) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    switch (ev->state) {
+    case ZMK_ACTIVITY_ACTIVE:
+        target_profile = ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_LATENCY;
+        k_work_reschedule(&conn_param_work, K_NO_WAIT);
+        break;
+    case ZMK_ACTIVITY_IDLE:
+    case ZMK_ACTIVITY_SLEEP:
+        target_profile = ZMK_SPLIT_BT_CONN_PARAM_PROFILE_LOW_POWER;
+        k_work_reschedule(&conn_param_work, K_MSEC(CONFIG_ZMK_SPLIT_BLE_LOW_POWER_DELAY_MS));
+        break;
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(split_central_conn_params, conn_params_listener);
+ZMK_SUBSCRIPTION(split_central_conn_params, zmk_activity_state_changed);
+
+static int conn_params_init(void) {
+    bt_conn_cb_register(&conn_callbacks);
+
+    return 0;
+}
+
+SYS_INIT(conn_params_init, APPLICATION, CONFIG_ZMK_BLE_INIT_PRIORITY);
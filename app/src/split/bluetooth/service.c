@@ -8,6 +8,7 @@
 #include <zephyr/types.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/init.h>
 
 #include <zephyr/logging/log.h>
@@ -51,6 +52,18 @@ static void split_svc_sensor_state_ccc(const struct bt_gatt_attr *attr, uint16_t
 
 #define POS_STATE_LEN 16
 
+// Indexes of the characteristic attributes in the service definition below
+#define POS_STATE_ATTR_IDX 1
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+#define POS_EVENTS_ATTR_IDX 4
+#define POS_EVENTS_ATTR_COUNT 3
+#else
+#define POS_EVENTS_ATTR_COUNT 0
+#endif
+
+#define SENSOR_STATE_ATTR_IDX (8 + POS_EVENTS_ATTR_COUNT)
+
 static uint8_t num_of_positions = ZMK_KEYMAP_LEN;
 static uint8_t position_state[POS_STATE_LEN];
 
@@ -66,6 +79,12 @@ static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt
                                       const void *buf, uint16_t len, uint16_t offset,
                                       uint8_t flags);
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+static ssize_t split_svc_run_behavior_by_local_id(struct bt_conn *conn,
+                                                  const struct bt_gatt_attr *attrs, const void *buf,
+                                                  uint16_t len, uint16_t offset, uint8_t flags);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+
 static ssize_t split_svc_num_of_positions(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
                                           void *buf, uint16_t len, uint16_t offset) {
     return bt_gatt_attr_read(conn, attrs, buf, len, offset, attrs->user_data, sizeof(uint8_t));
@@ -75,6 +94,17 @@ static void split_svc_pos_state_ccc(const struct bt_gatt_attr *attr, uint16_t va
     LOG_DBG("value %d", value);
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+
+static bool position_events_subscribed = false;
+
+static void split_svc_pos_events_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
+    LOG_DBG("value %d", value);
+    position_events_subscribed = (value == BT_GATT_CCC_NOTIFY);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
 
 static zmk_hid_indicators_t hid_indicators = 0;
@@ -184,6 +214,11 @@ BT_GATT_SERVICE_DEFINE(
                            BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT,
                            split_svc_pos_state, NULL, &position_state),
     BT_GATT_CCC(split_svc_pos_state_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_EVENTS_UUID),
+                           BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT, NULL, NULL, NULL),
+    BT_GATT_CCC(split_svc_pos_events_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
     BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_UUID),
                            BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
                            split_svc_run_behavior, &behavior_run_payload),
@@ -205,57 +240,469 @@ BT_GATT_SERVICE_DEFINE(
                            BT_GATT_CHRC_WRITE | BT_GATT_CHRC_READ,
                            BT_GATT_PERM_WRITE_ENCRYPT | BT_GATT_PERM_READ_ENCRYPT,
                            split_svc_get_selected_phys_layout, split_svc_select_phys_layout,
-                           NULL), );
+                           NULL),
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_BY_LOCAL_ID_UUID),
+                           BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
+                           split_svc_run_behavior_by_local_id, NULL),
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+);
 
 K_THREAD_STACK_DEFINE(service_q_stack, CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_STACK_SIZE);
 
 struct k_work_q service_work_q;
 
-K_MSGQ_DEFINE(position_state_msgq, sizeof(char[POS_STATE_LEN]),
-              CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
-
-void send_position_state_callback(struct k_work *work) {
+/*
+ * Position state changes are queued as snapshots of the whole state. A transition is folded into
+ * the newest queued snapshot unless that snapshot already changed the same position, in which
+ * case folding it would swallow a tap, so a new snapshot is started instead. Only one
+ * notification is in flight at a time, so everything that changes while the previous one waits
+ * for its connection event is sent together in the next one.
+ *
+ * Transitions that don't fit in the queue are counted per position instead, without blocking the
+ * caller, and queued as soon as there's room. A position alternates between pressed and released,
+ * so its count is enough to replay its transitions in order. Once anything is counted, later
+ * transitions are counted too, so none of them overtakes an earlier one. Transitions of different
+ * positions may be reordered, but none is lost unless a single position has more than 255 waiting.
+ */
+struct position_state_snapshot {
     uint8_t state[POS_STATE_LEN];
+    uint8_t changed[POS_STATE_LEN];
+};
+
+#define POS_STATE_QUEUE_SIZE CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE
+
+// Recover if a sent callback never arrives, e.g. because the connection dropped.
+#define POS_STATE_IN_FLIGHT_TIMEOUT_MS 100
+#define POS_STATE_RETRY_MS 5
+
+static struct position_state_snapshot position_state_queue[POS_STATE_QUEUE_SIZE];
+static uint8_t position_state_queue_head;
+static uint8_t position_state_queue_len;
+static struct k_spinlock position_state_lock;
+static struct zmk_split_bt_position_stats position_stats;
+
+// The state of each position as of its last transition that was queued rather than counted.
+static uint8_t position_state_queued[POS_STATE_LEN];
+static uint8_t position_overflow_counts[POS_STATE_LEN * 8];
+static uint16_t position_overflow_len;
+static uint8_t position_overflow_next;
+
+// Must be called with position_state_lock held.
+static void overflow_position(uint8_t position) {
+    if (position_overflow_counts[position] == UINT8_MAX) {
+        LOG_WRN("Too many transitions of position %d waiting to be sent, dropping a tap", position);
+        position_overflow_counts[position]--;
+        position_overflow_len--;
+        return;
+    }
+
+    position_overflow_counts[position]++;
+    position_overflow_len++;
+}
+
+// Must be called with position_state_lock held.
+static bool peek_overflowed_position(uint8_t *position, bool *pressed) {
+    if (position_overflow_len == 0) {
+        return false;
+    }
+
+    // Take turns, so each counted position gets one transition replayed per round.
+    for (int i = 0; i < POS_STATE_LEN * 8; i++) {
+        uint8_t candidate = (position_overflow_next + i) % (POS_STATE_LEN * 8);
+        if (position_overflow_counts[candidate] > 0) {
+            *position = candidate;
+            *pressed = !(position_state_queued[candidate / 8] & BIT(candidate % 8));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Must be called with position_state_lock held.
+static void take_overflowed_position(uint8_t position, bool pressed) {
+    WRITE_BIT(position_state_queued[position / 8], position % 8, pressed);
+    position_overflow_counts[position]--;
+    position_overflow_len--;
+    position_overflow_next = (position + 1) % (POS_STATE_LEN * 8);
+}
+
+// Only accessed from the service work queue
+static struct position_state_snapshot position_state_sending;
+static bool position_state_sending_valid;
+static int64_t position_state_in_flight_timestamp;
+static atomic_t position_state_in_flight;
+
+static void send_position_state_callback(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(service_position_notify_work, send_position_state_callback);
+
+static void position_state_sent(struct bt_conn *conn, void *user_data) {
+    atomic_clear(&position_state_in_flight);
+    k_work_reschedule_for_queue(&service_work_q, &service_position_notify_work, K_NO_WAIT);
+}
+
+// Must be called with position_state_lock held.
+static bool queue_position_state(uint8_t position, bool pressed) {
+    struct position_state_snapshot *tail = NULL;
+    if (position_state_queue_len > 0) {
+        tail = &position_state_queue[(position_state_queue_head + position_state_queue_len - 1) %
+                                     POS_STATE_QUEUE_SIZE];
+    }
+
+    if (tail && !(tail->changed[position / 8] & BIT(position % 8))) {
+        position_stats.coalesced++;
+    } else if (position_state_queue_len < POS_STATE_QUEUE_SIZE) {
+        tail = &position_state_queue[(position_state_queue_head + position_state_queue_len) %
+                                     POS_STATE_QUEUE_SIZE];
+        memset(tail->changed, 0, sizeof(tail->changed));
+        position_state_queue_len++;
+        position_stats.max_depth = MAX(position_stats.max_depth, position_state_queue_len);
+    } else {
+        return false;
+    }
+
+    WRITE_BIT(position_state_queued[position / 8], position % 8, pressed);
+    memcpy(tail->state, position_state_queued, sizeof(tail->state));
+    WRITE_BIT(tail->changed[position / 8], position % 8, true);
+
+    return true;
+}
+
+static bool dequeue_position_state(struct position_state_snapshot *snapshot) {
+    k_spinlock_key_t key = k_spin_lock(&position_state_lock);
+
+    if (position_state_queue_len == 0) {
+        k_spin_unlock(&position_state_lock, key);
+        return false;
+    }
+
+    *snapshot = position_state_queue[position_state_queue_head];
+    position_state_queue_head = (position_state_queue_head + 1) % POS_STATE_QUEUE_SIZE;
+    position_state_queue_len--;
+
+    uint8_t position;
+    bool pressed;
+    while (peek_overflowed_position(&position, &pressed) &&
+           queue_position_state(position, pressed)) {
+        take_overflowed_position(position, pressed);
+    }
+
+    k_spin_unlock(&position_state_lock, key);
+
+    return true;
+}
+
+static void send_position_state_callback(struct k_work *work) {
+    while (true) {
+        if (atomic_get(&position_state_in_flight)) {
+            int64_t in_flight_ms = k_uptime_get() - position_state_in_flight_timestamp;
+            if (in_flight_ms < POS_STATE_IN_FLIGHT_TIMEOUT_MS) {
+                k_work_schedule_for_queue(&service_work_q, &service_position_notify_work,
+                                          K_MSEC(POS_STATE_IN_FLIGHT_TIMEOUT_MS - in_flight_ms));
+                return;
+            }
+
+            LOG_WRN("Position state notification not sent after %dms, sending next one",
+                    POS_STATE_IN_FLIGHT_TIMEOUT_MS);
+            atomic_clear(&position_state_in_flight);
+        }
+
+        if (!position_state_sending_valid) {
+            if (!dequeue_position_state(&position_state_sending)) {
+                return;
+            }
+
+            position_state_sending_valid = true;
+        }
+
+        struct bt_gatt_notify_params params = {
+            .attr = &split_svc.attrs[POS_STATE_ATTR_IDX],
+            .data = position_state_sending.state,
+            .len = sizeof(position_state_sending.state),
+            .func = position_state_sent,
+        };
+
+        atomic_set(&position_state_in_flight, 1);
+        position_state_in_flight_timestamp = k_uptime_get();
+
+        int err = bt_gatt_notify_cb(NULL, &params);
+        if (err == -ENOMEM) {
+            // Keep the snapshot and try again once buffers have been freed
+            atomic_clear(&position_state_in_flight);
+            k_work_schedule_for_queue(&service_work_q, &service_position_notify_work,
+                                      K_MSEC(POS_STATE_RETRY_MS));
+            return;
+        }
+
+        position_state_sending_valid = false;
 
-    while (k_msgq_get(&position_state_msgq, &state, K_NO_WAIT) == 0) {
-        int err = bt_gatt_notify(NULL, &split_svc.attrs[1], &state, sizeof(state));
         if (err) {
             LOG_DBG("Error notifying %d", err);
+            atomic_clear(&position_state_in_flight);
         }
     }
+}
+
+static int send_position_state(uint8_t position, bool pressed) {
+    k_spinlock_key_t key = k_spin_lock(&position_state_lock);
+
+    if (position_overflow_len > 0 || !queue_position_state(position, pressed)) {
+        LOG_DBG("Position state queue full, sending position %d once there's room", position);
+        position_stats.state_overflows++;
+        overflow_position(position);
+    }
+
+    k_spin_unlock(&position_state_lock, key);
+
+    k_work_reschedule_for_queue(&service_work_q, &service_position_notify_work, K_NO_WAIT);
+
+    return 0;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+
+#define POS_EVENTS_MAX_RECORDS 16
+
+struct position_event {
+    int64_t timestamp;
+    uint8_t position;
+    bool pressed;
 };
 
-K_WORK_DEFINE(service_position_notify_work, send_position_state_callback);
+K_MSGQ_DEFINE(position_event_msgq, sizeof(struct position_event),
+              CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 8);
 
-int send_position_state() {
-    int err = k_msgq_put(&position_state_msgq, position_state, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Position state message queue full, popping first message and queueing again");
-            uint8_t discarded_state[POS_STATE_LEN];
-            k_msgq_get(&position_state_msgq, &discarded_state, K_NO_WAIT);
-            return send_position_state();
+static void find_min_mtu(struct bt_conn *conn, void *data) {
+    uint16_t *mtu = data;
+
+    *mtu = MIN(*mtu, bt_gatt_get_mtu(conn));
+}
+
+static size_t position_events_per_notification(void) {
+    uint16_t mtu = UINT16_MAX;
+    bt_conn_foreach(BT_CONN_TYPE_LE, find_min_mtu, &mtu);
+
+    // 3 bytes of each notification are used by the ATT header
+    size_t available = mtu - 3 - sizeof(struct zmk_split_position_events_header);
+
+    return CLAMP(available / sizeof(struct zmk_split_position_event_record), 1,
+                 POS_EVENTS_MAX_RECORDS);
+}
+
+/*
+ * When the event queue is full, new events are counted per position like position state
+ * transitions are, instead of blocking the caller, and sent once the queue has drained. They are
+ * all sent with the time of the last counted one.
+ */
+static int64_t position_events_overflow_timestamp;
+
+static bool next_position_event(struct position_event *ev) {
+    if (k_msgq_get(&position_event_msgq, ev, K_NO_WAIT) == 0) {
+        return true;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&position_state_lock);
+
+    uint8_t position;
+    bool pressed;
+    bool found = peek_overflowed_position(&position, &pressed);
+    if (found) {
+        take_overflowed_position(position, pressed);
+        *ev = (struct position_event){
+            .timestamp = position_events_overflow_timestamp,
+            .position = position,
+            .pressed = pressed,
+        };
+    }
+
+    k_spin_unlock(&position_state_lock, key);
+
+    return found;
+}
+
+/*
+ * Like the position state, only one event notification is in flight at a time. Events raised
+ * while it waits for its connection event queue up and are sent together in the next one.
+ */
+
+// Only accessed from the service work queue
+static uint8_t position_events_sending[sizeof(struct zmk_split_position_events_header) +
+                                       POS_EVENTS_MAX_RECORDS *
+                                           sizeof(struct zmk_split_position_event_record)];
+static uint8_t position_events_sending_count;
+static int64_t position_events_sending_timestamp;
+static int64_t position_events_in_flight_timestamp;
+static atomic_t position_events_in_flight;
+
+static void send_position_events_callback(struct k_work *work);
+
+K_WORK_DELAYABLE_DEFINE(service_position_events_notify_work, send_position_events_callback);
+
+static void position_events_sent(struct bt_conn *conn, void *user_data) {
+    atomic_clear(&position_events_in_flight);
+    k_work_reschedule_for_queue(&service_work_q, &service_position_events_notify_work, K_NO_WAIT);
+}
+
+static uint8_t collect_position_events(struct zmk_split_position_event_record *records,
+                                       size_t max_records, int64_t *last_timestamp) {
+    struct position_event ev;
+    uint8_t count = 0;
+
+    while (count < max_records && next_position_event(&ev)) {
+        uint16_t delta =
+            count > 0 ? MIN(ev.timestamp - *last_timestamp, ZMK_SPLIT_POSITION_EVENT_DELTA_MAX)
+                      : 0;
+
+        records[count].position = ev.position;
+        records[count].state_delta =
+            sys_cpu_to_le16(delta | (ev.pressed ? ZMK_SPLIT_POSITION_EVENT_PRESSED : 0));
+        *last_timestamp = ev.timestamp;
+        count++;
+    }
+
+    if (count > 1) {
+        k_spinlock_key_t key = k_spin_lock(&position_state_lock);
+        position_stats.coalesced += count - 1;
+        k_spin_unlock(&position_state_lock, key);
+    }
+
+    return count;
+}
+
+static void send_position_events_callback(struct k_work *work) {
+    struct zmk_split_position_events_header *header =
+        (struct zmk_split_position_events_header *)position_events_sending;
+    struct zmk_split_position_event_record *records =
+        (struct zmk_split_position_event_record *)(position_events_sending + sizeof(*header));
+
+    while (true) {
+        if (atomic_get(&position_events_in_flight)) {
+            int64_t in_flight_ms = k_uptime_get() - position_events_in_flight_timestamp;
+            if (in_flight_ms < POS_STATE_IN_FLIGHT_TIMEOUT_MS) {
+                k_work_schedule_for_queue(&service_work_q, &service_position_events_notify_work,
+                                          K_MSEC(POS_STATE_IN_FLIGHT_TIMEOUT_MS - in_flight_ms));
+                return;
+            }
+
+            LOG_WRN("Position events notification not sent after %dms, sending next one",
+                    POS_STATE_IN_FLIGHT_TIMEOUT_MS);
+            atomic_clear(&position_events_in_flight);
         }
-        default:
-            LOG_WRN("Failed to queue position state to send (%d)", err);
-            return err;
+
+        if (position_events_sending_count == 0) {
+            position_events_sending_count =
+                collect_position_events(records, position_events_per_notification(),
+                                        &position_events_sending_timestamp);
+            if (position_events_sending_count == 0) {
+                return;
+            }
+        }
+
+        header->version = ZMK_SPLIT_POSITION_EVENTS_VERSION;
+        header->count = position_events_sending_count;
+        header->age = sys_cpu_to_le16(
+            MIN(k_uptime_get() - position_events_sending_timestamp, UINT16_MAX));
+
+        struct bt_gatt_notify_params params = {
+            .attr = &split_svc.attrs[POS_EVENTS_ATTR_IDX],
+            .data = position_events_sending,
+            .len = sizeof(*header) + position_events_sending_count * sizeof(*records),
+            .func = position_events_sent,
+        };
+
+        atomic_set(&position_events_in_flight, 1);
+        position_events_in_flight_timestamp = k_uptime_get();
+
+        int err = bt_gatt_notify_cb(NULL, &params);
+        if (err == -ENOMEM) {
+            // Keep the batch and try again once buffers have been freed
+            atomic_clear(&position_events_in_flight);
+            k_work_schedule_for_queue(&service_work_q, &service_position_events_notify_work,
+                                      K_MSEC(POS_STATE_RETRY_MS));
+            return;
+        }
+
+        position_events_sending_count = 0;
+
+        if (err) {
+            LOG_DBG("Error notifying %d", err);
+            atomic_clear(&position_events_in_flight);
+        }
+    }
+}
+
+static int send_position_event(uint8_t position, bool pressed) {
+    struct position_event ev = {
+        .timestamp = k_uptime_get(),
+        .position = position,
+        .pressed = pressed,
+    };
+
+    bool dropped = false;
+    k_spinlock_key_t key = k_spin_lock(&position_state_lock);
+
+    if (position_overflow_len > 0 || k_msgq_put(&position_event_msgq, &ev, K_NO_WAIT) != 0) {
+        position_stats.event_overflows++;
+
+        if (position < POS_STATE_LEN * 8) {
+            overflow_position(position);
+            position_events_overflow_timestamp = ev.timestamp;
+        } else {
+            dropped = true;
         }
+    } else if (position < POS_STATE_LEN * 8) {
+        WRITE_BIT(position_state_queued[position / 8], position % 8, pressed);
     }
 
-    k_work_submit_to_queue(&service_work_q, &service_position_notify_work);
+    position_stats.max_depth =
+        MAX(position_stats.max_depth, k_msgq_num_used_get(&position_event_msgq));
+
+    k_spin_unlock(&position_state_lock, key);
+
+    k_work_reschedule_for_queue(&service_work_q, &service_position_events_notify_work, K_NO_WAIT);
+
+    if (dropped) {
+        LOG_WRN("Position event queue full, dropping position %d", position);
+        return -ENOMEM;
+    }
 
     return 0;
 }
 
-static int zmk_split_bt_position_pressed(uint8_t position) {
-    WRITE_BIT(position_state[position / 8], position % 8, true);
-    return send_position_state();
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+
+void zmk_split_bt_get_position_stats(struct zmk_split_bt_position_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&position_state_lock);
+
+    *stats = position_stats;
+    stats->depth = MIN(position_state_queue_len + position_overflow_len, UINT8_MAX);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+    stats->depth = MIN(stats->depth + k_msgq_num_used_get(&position_event_msgq), UINT8_MAX);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+
+    k_spin_unlock(&position_state_lock, key);
 }
 
-static int zmk_split_bt_position_released(uint8_t position) {
-    WRITE_BIT(position_state[position / 8], position % 8, false);
-    return send_position_state();
+static int zmk_split_bt_position_changed(uint8_t position, bool pressed) {
+    if (position < POS_STATE_LEN * 8) {
+        WRITE_BIT(position_state[position / 8], position % 8, pressed);
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+    // Centrals that support the event stream don't need the position state as well
+    if (position_events_subscribed) {
+        return send_position_event(position, pressed);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_EVENTS)
+
+    if (position >= POS_STATE_LEN * 8) {
+        LOG_WRN("Position %d can't be sent in the position state", position);
+        return -EINVAL;
+    }
+
+    return send_position_state(position, pressed);
 }
 
 #if ZMK_KEYMAP_HAS_SENSORS
@@ -264,7 +711,7 @@ K_MSGQ_DEFINE(sensor_state_msgq, sizeof(struct sensor_event),
 
 void send_sensor_state_callback(struct k_work *work) {
     while (k_msgq_get(&sensor_state_msgq, &last_sensor_event, K_NO_WAIT) == 0) {
-        int err = bt_gatt_notify(NULL, &split_svc.attrs[8], &last_sensor_event,
+        int err = bt_gatt_notify(NULL, &split_svc.attrs[SENSOR_STATE_ATTR_IDX], &last_sensor_event,
                                  sizeof(last_sensor_event));
         if (err) {
             LOG_DBG("Error notifying %d", err);
@@ -349,11 +796,8 @@ int zmk_split_transport_peripheral_bt_report_event(
     const struct zmk_split_transport_peripheral_event *ev) {
     switch (ev->type) {
     case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
-        if (ev->data.key_position_event.pressed) {
-            zmk_split_bt_position_pressed(ev->data.key_position_event.position);
-        } else {
-            zmk_split_bt_position_released(ev->data.key_position_event.position);
-        }
+        zmk_split_bt_position_changed(ev->data.key_position_event.position,
+                                      ev->data.key_position_event.pressed);
         break;
 #if ZMK_KEYMAP_HAS_SENSORS
     case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
@@ -434,4 +878,47 @@ static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt
     }
 
     return len;
-}
\ No newline at end of file
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+
+static ssize_t split_svc_run_behavior_by_local_id(struct bt_conn *conn,
+                                                  const struct bt_gatt_attr *attrs, const void *buf,
+                                                  uint16_t len, uint16_t offset, uint8_t flags) {
+    struct zmk_split_run_behavior_by_local_id_payload payload;
+
+    LOG_DBG("offset %d len %d", offset, len);
+
+    // The compact payload always fits in a single write, so partial writes are rejected.
+    if (offset != 0) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+    }
+
+    if (len != sizeof(payload)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    memcpy(&payload, buf, len);
+
+    struct zmk_split_transport_central_command cmd = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR_BY_LOCAL_ID,
+        .data = {.invoke_behavior_by_local_id = {
+                     .local_id = payload.local_id,
+                     .param1 = payload.data.param1,
+                     .param2 = payload.data.param2,
+                     .position = payload.data.position,
+                     .event_source = payload.data.source,
+                     .state = payload.data.state,
+                 }}};
+
+    int err =
+        zmk_split_transport_peripheral_command_handler(zmk_split_transport_peripheral_bt(), cmd);
+
+    if (err) {
+        LOG_ERR("Failed to invoke behavior with local ID %d: %d", payload.local_id, err);
+    }
+
+    return len;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
\ No newline at end of file
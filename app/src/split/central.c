@@ -9,6 +9,7 @@
 #include <zmk/stdlib.h>
 #include <zmk/split/transport/central.h>
 #include <zmk/split/central.h>
+#include <zmk/behavior.h>
 #include <zmk/hid_indicators_types.h>
 #include <zmk/pointing/input_split.h>
 
@@ -32,6 +33,13 @@ static uint8_t peripheral_battery_levels[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT] = {
 int zmk_split_transport_central_peripheral_event_handler(
     const struct zmk_split_transport_central *transport, uint8_t source,
     struct zmk_split_transport_peripheral_event ev) {
+    return zmk_split_transport_central_peripheral_event_handler_at(transport, source, ev,
+                                                                   k_uptime_get());
+}
+
+int zmk_split_transport_central_peripheral_event_handler_at(
+    const struct zmk_split_transport_central *transport, uint8_t source,
+    struct zmk_split_transport_peripheral_event ev, int64_t timestamp) {
     if (transport != active_transport) {
         // Ignoring events from non-active transport
         LOG_WRN("Ignoring peripheral event from non-active transport");
@@ -43,7 +51,7 @@ int zmk_split_transport_central_peripheral_event_handler(
                                                       .position =
                                                           ev.data.key_position_event.position,
                                                       .state = ev.data.key_position_event.pressed,
-                                                      .timestamp = k_uptime_get()};
+                                                      .timestamp = timestamp};
         return raise_zmk_position_state_changed(state_ev);
     }
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
@@ -66,7 +74,7 @@ int zmk_split_transport_central_peripheral_event_handler(
     case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT: {
         struct zmk_sensor_event sensor_ev = {.sensor_index = ev.data.sensor_event.sensor_index,
                                              .channel_data_size = 1,
-                                             .timestamp = k_uptime_get()};
+                                             .timestamp = timestamp};
 
         sensor_ev.channel_data[0] = ev.data.sensor_event.channel_data;
 
@@ -84,6 +92,31 @@ int zmk_split_central_invoke_behavior(uint8_t source, struct zmk_behavior_bindin
         return -ENODEV;
     }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+    zmk_behavior_local_id_t local_id =
+        zmk_behavior_get_local_id_for_device(zmk_behavior_get_binding_device(binding));
+
+    if (local_id != UINT16_MAX) {
+        struct zmk_split_transport_central_command command = {
+            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR_BY_LOCAL_ID,
+            .data =
+                {
+                    .invoke_behavior_by_local_id =
+                        {
+                            .local_id = local_id,
+                            .param1 = binding->param1,
+                            .param2 = binding->param2,
+                            .position = event.position,
+                            .event_source = event.source,
+                            .state = state ? 1 : 0,
+                        },
+                },
+        };
+
+        return active_transport->api->send_command(source, command);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+
     struct zmk_split_transport_central_command command =
         (struct zmk_split_transport_central_command){
             .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
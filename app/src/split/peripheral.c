@@ -50,7 +50,47 @@ int zmk_split_transport_peripheral_command_handler(
         if (err) {
             LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
         }
+
+        return err;
+    }
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR_BY_LOCAL_ID: {
+        const struct device *behavior =
+            zmk_behavior_get_device_from_local_id(cmd.data.invoke_behavior_by_local_id.local_id);
+        if (!behavior) {
+            LOG_ERR("No behavior with local ID %d",
+                    cmd.data.invoke_behavior_by_local_id.local_id);
+            return -ENODEV;
+        }
+
+        struct zmk_behavior_binding binding = {
+            .param1 = cmd.data.invoke_behavior_by_local_id.param1,
+            .param2 = cmd.data.invoke_behavior_by_local_id.param2,
+            .behavior_dev = behavior->name,
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+            .behavior_device = behavior,
+#endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_DEVICES_IN_BINDINGS)
+        };
+        LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
+                binding.param2, cmd.data.invoke_behavior_by_local_id.state);
+        struct zmk_behavior_binding_event event = {
+            .position = cmd.data.invoke_behavior_by_local_id.position,
+            .timestamp = k_uptime_get()};
+
+        int err;
+        if (cmd.data.invoke_behavior_by_local_id.state > 0) {
+            err = behavior_keymap_binding_pressed(&binding, event);
+        } else {
+            err = behavior_keymap_binding_released(&binding, event);
+        }
+
+        if (err) {
+            LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+        }
+
+        return err;
     }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID)
     default:
         LOG_WRN("Unhandled command type %d", cmd.type);
         return -ENOTSUP;
@@ -39,7 +39,9 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
     (DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT) && DT_INST_PROP_OR(0, half_duplex, false))
 
 #define RX_BUFFER_SIZE                                                                             \
-    ((sizeof(struct event_envelope) + sizeof(struct msg_postfix)) *                                \
+    ((sizeof(struct msg_prefix) + sizeof(struct event_frame_header) +                              \
+      sizeof(struct event_frame_record) + sizeof(struct zmk_split_transport_peripheral_event) +    \
+      sizeof(struct msg_postfix)) *                                                                \
      CONFIG_ZMK_SPLIT_WIRED_EVENT_BUFFER_ITEMS)
 #define TX_BUFFER_SIZE                                                                             \
     ((sizeof(struct command_envelope) + sizeof(struct msg_postfix)) *                              \
@@ -87,11 +89,30 @@ K_WORK_DEFINE(publish_events, publish_events_work);
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
+/*
+ * Received data stays in the DMA buffers until it has been dispatched, so each buffer only needs
+ * to hold what arrives between two RX timeouts, and a few are needed to keep receiving meanwhile.
+ */
+static uint8_t async_rx_buf[ZMK_SPLIT_WIRED_ASYNC_RX_BUFS][RX_BUFFER_SIZE / 2];
+
+K_MSGQ_DEFINE(rx_span_msgq, sizeof(struct zmk_split_wired_rx_span),
+              ZMK_SPLIT_WIRED_ASYNC_RX_BUFS * 4, 4);
+
+#define ASYNC_RX_BUF_PTR(n, _) async_rx_buf[n]
+
+static struct zmk_split_wired_async_state async_state = {
+    .process_tx_work = &publish_events,
+    .rx_bufs = {LISTIFY(ZMK_SPLIT_WIRED_ASYNC_RX_BUFS, ASYNC_RX_BUF_PTR, (, ))},
+    .rx_spans = &rx_span_msgq,
+#else
 uint8_t async_rx_buf[RX_BUFFER_SIZE / 2][2];
 
 static struct zmk_split_wired_async_state async_state = {
     .process_tx_work = &publish_events,
     .rx_bufs = {async_rx_buf[0], async_rx_buf[1]},
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
     .rx_bufs_len = RX_BUFFER_SIZE / 2,
     .rx_size_process_trigger = MSG_EXTRA_SIZE + 1,
     .rx_buf = &rx_buf,
@@ -174,6 +195,8 @@ static ssize_t get_payload_data_size(const struct zmk_split_transport_central_co
         return 0;
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR:
         return sizeof(cmd->data.invoke_behavior);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR_BY_LOCAL_ID:
+        return sizeof(cmd->data.invoke_behavior_by_local_id);
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
         return sizeof(cmd->data.set_physical_layout);
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS:
@@ -183,12 +206,62 @@ static ssize_t get_payload_data_size(const struct zmk_split_transport_central_co
     }
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID) &&                                  \
+    !IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+
+// Older peripherals only know behaviors by name, so fall back to it like the BLE transport does
+// when the peripheral lacks the local ID characteristic.
+static int invoke_behavior_by_name(struct zmk_split_transport_central_command *cmd) {
+    zmk_behavior_local_id_t local_id = cmd->data.invoke_behavior_by_local_id.local_id;
+    const char *behavior_dev = zmk_behavior_find_behavior_name_from_local_id(local_id);
+    if (!behavior_dev) {
+        LOG_ERR("No behavior with local ID %d", local_id);
+        return -ENODEV;
+    }
+
+    struct zmk_split_transport_central_command name_cmd = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
+        .data =
+            {
+                .invoke_behavior =
+                    {
+                        .param1 = cmd->data.invoke_behavior_by_local_id.param1,
+                        .param2 = cmd->data.invoke_behavior_by_local_id.param2,
+                        .position = cmd->data.invoke_behavior_by_local_id.position,
+                        .event_source = cmd->data.invoke_behavior_by_local_id.event_source,
+                        .state = cmd->data.invoke_behavior_by_local_id.state,
+                    },
+            },
+    };
+    const size_t payload_dev_size = sizeof(name_cmd.data.invoke_behavior.behavior_dev);
+    if (strlcpy(name_cmd.data.invoke_behavior.behavior_dev, behavior_dev, payload_dev_size) >=
+        payload_dev_size) {
+        LOG_ERR("Truncated behavior label %s to %s before invoking", behavior_dev,
+                name_cmd.data.invoke_behavior.behavior_dev);
+    }
+
+    *cmd = name_cmd;
+    return 0;
+}
+
+#endif
+
 static int split_central_wired_send_command(uint8_t source,
                                             struct zmk_split_transport_central_command cmd) {
     if (source != 0) {
         return -EINVAL;
     }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_INVOKE_BEHAVIOR_BY_LOCAL_ID) &&                                  \
+    !IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_INVOKE_BEHAVIOR_BY_LOCAL_ID)
+    if (cmd.type == ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR_BY_LOCAL_ID) {
+        int err = invoke_behavior_by_name(&cmd);
+        if (err < 0) {
+            return err;
+        }
+    }
+#endif
+
     ssize_t data_size = get_payload_data_size(&cmd);
     if (data_size < 0) {
         LOG_WRN("Failed to determine payload data size %d", data_size);
@@ -461,27 +534,102 @@ static void notify_transport_status(void) {
 
 #endif
 
+static void publish_frame_events(const uint8_t *frame, size_t len, void *user_data) {
+    const uint8_t *end = frame + len;
+    const uint8_t *pos = frame + sizeof(struct msg_prefix);
+
+    if (end - pos < sizeof(struct event_frame_header)) {
+        LOG_WRN("Frame too short for its header");
+        return;
+    }
+
+    struct event_frame_header header;
+    memcpy(&header, pos, sizeof(header));
+    pos += sizeof(header);
+
+    int64_t start = k_uptime_get() - header.age;
+
+    for (int i = 0; i < header.count; i++) {
+        struct event_frame_record record;
+        if (end - pos < sizeof(record)) {
+            LOG_WRN("Frame truncated after %d of %d events", i, header.count);
+            return;
+        }
+
+        memcpy(&record, pos, sizeof(record));
+        pos += sizeof(record);
+
+        ssize_t data_size = zmk_split_wired_event_data_size(record.type);
+        if (data_size < 0 || end - pos < data_size) {
+            LOG_WRN("Invalid event of type %d in frame", record.type);
+            return;
+        }
+
+        struct zmk_split_transport_peripheral_event ev = {.type = record.type};
+        memcpy(&ev.data, pos, data_size);
+        pos += data_size;
+
+        zmk_split_transport_central_peripheral_event_handler_at(&wired_central, header.source, ev,
+                                                                start + record.offset);
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
+static void publish_span_events(const struct zmk_split_wired_rx_span *span) {
+    const uint8_t *data = span->data;
+    size_t len = span->len;
+
+    // Whole frames are dispatched in place, unless part of a frame is already waiting in rx_buf.
+    while (len > 0 && ring_buf_is_empty(&rx_buf)) {
+        size_t consumed;
+        int err = zmk_split_wired_parse_frame(data, len, ZMK_SPLIT_WIRED_EVENT_FRAME_MAGIC_PREFIX,
+                                              EVENT_FRAME_MAX_SIZE, publish_frame_events, NULL,
+                                              &consumed);
+        data += consumed;
+        len -= consumed;
+
+        if (err == -EAGAIN) {
+            break;
+        }
+    }
+
+    if (len > 0 && ring_buf_put(&rx_buf, data, len) < len) {
+        LOG_ERR("RX overrun!");
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
 static void publish_events_work(struct k_work *work) {
+    static uint8_t frame_scratch[EVENT_FRAME_MAX_SIZE];
 
 #if IS_HALF_DUPLEX_MODE
     k_work_reschedule(&rx_done_work,
                       K_MSEC(CONFIG_ZMK_SPLIT_WIRED_HALF_DUPLEX_RX_COMPLETE_TIMEOUT));
 #endif // IS_HALF_DUPLEX_MODE
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+    struct zmk_split_wired_rx_span span;
+    while (k_msgq_get(&rx_span_msgq, &span, K_NO_WAIT) == 0) {
+        publish_span_events(&span);
+        zmk_split_wired_async_rx_span_done(&async_state, &span);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
     while (ring_buf_size_get(&rx_buf) > MSG_EXTRA_SIZE) {
-        struct event_envelope env;
-        int item_err =
-            zmk_split_wired_get_item(&rx_buf, (uint8_t *)&env, sizeof(struct event_envelope));
+        int item_err = zmk_split_wired_process_frame(
+            &rx_buf, ZMK_SPLIT_WIRED_EVENT_FRAME_MAGIC_PREFIX, frame_scratch,
+            sizeof(frame_scratch), publish_frame_events, NULL);
         switch (item_err) {
         case 0:
-            zmk_split_transport_central_peripheral_event_handler(&wired_central, env.payload.source,
-                                                                 env.payload.event);
             break;
         case -EAGAIN:
             return;
         default:
+            // The bad frame has been consumed, so carry on with whatever follows it.
             LOG_WRN("Issue fetching an item from the RX buffer: %d", item_err);
-            return;
+            break;
         }
     }
 }
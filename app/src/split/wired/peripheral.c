@@ -40,7 +40,9 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
     (DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT) && DT_INST_PROP_OR(0, half_duplex, false))
 
 #define TX_BUFFER_SIZE                                                                             \
-    ((sizeof(struct event_envelope) + sizeof(struct msg_postfix)) *                                \
+    ((sizeof(struct msg_prefix) + sizeof(struct event_frame_header) +                              \
+      sizeof(struct event_frame_record) + sizeof(struct zmk_split_transport_peripheral_event) +    \
+      sizeof(struct msg_postfix)) *                                                                \
      CONFIG_ZMK_SPLIT_WIRED_EVENT_BUFFER_ITEMS)
 #define RX_BUFFER_SIZE                                                                             \
     ((sizeof(struct command_envelope) + sizeof(struct msg_postfix)) *                              \
@@ -275,67 +277,122 @@ static void begin_tx(void) {
 #endif
 }
 
-static ssize_t get_payload_data_size(const struct zmk_split_transport_peripheral_event *evt) {
-    switch (evt->type) {
-    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT:
-        return sizeof(evt->data.input_event);
-    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
-        return sizeof(evt->data.key_position_event);
-    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
-        return sizeof(evt->data.sensor_event);
-    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BATTERY_EVENT:
-        return sizeof(evt->data.battery_event);
-    default:
-        return -ENOTSUP;
+/*
+ * Events reported while handling one scan are collected into a single frame, which is written to
+ * the TX buffer once the current work item is done, or right away when the central polls. While
+ * the TX buffer has no room for it, the frame stays pending and keeps collecting events.
+ */
+#define PENDING_FRAME_MAX_PAYLOAD_SIZE                                                             \
+    MIN(EVENT_FRAME_MAX_PAYLOAD_SIZE, TX_BUFFER_SIZE - MSG_EXTRA_SIZE)
+
+static struct k_spinlock pending_frame_lock;
+static uint8_t pending_frame_payload[PENDING_FRAME_MAX_PAYLOAD_SIZE];
+static size_t pending_frame_len;
+static int64_t pending_frame_start;
+
+// Must be called with pending_frame_lock held.
+static int flush_pending_frame(void) {
+    if (pending_frame_len == 0) {
+        return 0;
+    }
+
+    struct event_frame_header *header = (struct event_frame_header *)pending_frame_payload;
+    header->age = MIN(k_uptime_get() - pending_frame_start, UINT16_MAX);
+
+    struct msg_prefix prefix = {
+        .magic_prefix = ZMK_SPLIT_WIRED_EVENT_FRAME_MAGIC_PREFIX,
+        .payload_size = pending_frame_len,
+    };
+
+    uint32_t crc = crc32_ieee((uint8_t *)&prefix, sizeof(prefix));
+    crc = crc32_ieee_update(crc, pending_frame_payload, pending_frame_len);
+    struct msg_postfix postfix = {.crc = crc};
+
+    size_t frame_size = MSG_EXTRA_SIZE + pending_frame_len;
+
+    // Keep the frame pending until what's already queued for the central has been sent.
+    if (ring_buf_space_get(&chosen_tx_buf) < frame_size) {
+        LOG_DBG("No room to send peripheral events yet (have %d but only space for %d)",
+                frame_size, ring_buf_space_get(&chosen_tx_buf));
+        return -ENOSPC;
+    }
+
+    LOG_HEXDUMP_DBG(pending_frame_payload, pending_frame_len, "Payload");
+
+    ring_buf_put(&chosen_tx_buf, (uint8_t *)&prefix, sizeof(prefix));
+    ring_buf_put(&chosen_tx_buf, pending_frame_payload, pending_frame_len);
+    ring_buf_put(&chosen_tx_buf, (uint8_t *)&postfix, sizeof(postfix));
+
+    pending_frame_len = 0;
+
+    return 0;
+}
+
+static void flush_events_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(flush_events_work, flush_events_work_cb);
+
+static void flush_events_work_cb(struct k_work *work) {
+    k_spinlock_key_t key = k_spin_lock(&pending_frame_lock);
+    int err = flush_pending_frame();
+    k_spin_unlock(&pending_frame_lock, key);
+
+    if (err == -ENOSPC) {
+        k_work_schedule(&flush_events_work, K_MSEC(1));
     }
+
+#if !IS_HALF_DUPLEX_MODE
+    begin_tx();
+#endif
 }
 
 static int
 split_peripheral_wired_report_event(const struct zmk_split_transport_peripheral_event *event) {
-    ssize_t data_size = get_payload_data_size(event);
+    ssize_t data_size = zmk_split_wired_event_data_size(event->type);
     if (data_size < 0) {
         LOG_WRN("Failed to determine payload data size %d", data_size);
         return data_size;
     }
 
-    // Data + type + source
-    size_t payload_size =
-        data_size + sizeof(peripheral_id) + sizeof(enum zmk_split_transport_peripheral_event_type);
+    size_t record_size = sizeof(struct event_frame_record) + data_size;
+    int64_t now = k_uptime_get();
+    int err = 0;
 
-    if (ring_buf_space_get(&chosen_tx_buf) < MSG_EXTRA_SIZE + payload_size) {
-        LOG_WRN("No room to send peripheral to the central (have %d but only space for %d)",
-                MSG_EXTRA_SIZE + payload_size, ring_buf_space_get(&chosen_tx_buf));
-        return -ENOSPC;
-    }
+    k_spinlock_key_t key = k_spin_lock(&pending_frame_lock);
+
+    if (pending_frame_len + record_size > sizeof(pending_frame_payload)) {
+        err = flush_pending_frame();
+        if (err < 0) {
+            k_spin_unlock(&pending_frame_lock, key);
 
-    struct event_envelope env = {.prefix =
-                                     {
-                                         .magic_prefix = ZMK_SPLIT_WIRED_ENVELOPE_MAGIC_PREFIX,
-                                         .payload_size = payload_size,
-                                     },
-                                 .payload = {
-                                     .source = peripheral_id,
-                                     .event = *event,
-                                 }};
-
-    struct msg_postfix postfix = {.crc =
-                                      crc32_ieee((void *)&env, sizeof(env.prefix) + payload_size)};
-
-    LOG_HEXDUMP_DBG(&env, sizeof(env.prefix) + payload_size, "Payload");
-
-    size_t put = ring_buf_put(&chosen_tx_buf, (uint8_t *)&env, sizeof(env.prefix) + payload_size);
-    if (put != sizeof(env.prefix) + payload_size) {
-        LOG_WRN("Failed to put the whole message (%d vs %d)", put,
-                sizeof(env.prefix) + payload_size);
+            // Both the pending frame and the TX buffer are full, there's nowhere to keep it.
+            LOG_ERR("No room to queue peripheral event of type %d", event->type);
+            return err;
+        }
     }
-    put = ring_buf_put(&chosen_tx_buf, (uint8_t *)&postfix, sizeof(postfix));
-    if (put != sizeof(postfix)) {
-        LOG_WRN("Failed to put the whole message (%d vs %d)", put, sizeof(postfix));
+
+    struct event_frame_header *header = (struct event_frame_header *)pending_frame_payload;
+
+    if (pending_frame_len == 0) {
+        header->source = peripheral_id;
+        header->count = 0;
+        pending_frame_len = sizeof(*header);
+        pending_frame_start = now;
     }
 
-#if !IS_HALF_DUPLEX_MODE
-    begin_tx();
-#endif
+    struct event_frame_record record = {
+        .offset = MIN(now - pending_frame_start, UINT16_MAX),
+        .type = event->type,
+    };
+
+    memcpy(pending_frame_payload + pending_frame_len, &record, sizeof(record));
+    memcpy(pending_frame_payload + pending_frame_len + sizeof(record), &event->data, data_size);
+    pending_frame_len += record_size;
+    header->count++;
+
+    k_spin_unlock(&pending_frame_lock, key);
+
+    k_work_schedule(&flush_events_work, K_NO_WAIT);
 
     return 0;
 }
@@ -424,6 +481,10 @@ static void process_tx_cb(void) {
         switch (item_err) {
         case 0:
             if (env.payload.cmd.type == ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_POLL_EVENTS) {
+                k_spinlock_key_t key = k_spin_lock(&pending_frame_lock);
+                flush_pending_frame();
+                k_spin_unlock(&pending_frame_lock, key);
+
                 begin_tx();
             } else {
                 int ret = k_msgq_put(&cmd_msg_queue, &env.payload.cmd, K_NO_WAIT);
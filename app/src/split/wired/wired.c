@@ -122,10 +122,42 @@ void zmk_split_wired_fifo_fill(const struct device *dev, struct ring_buf *tx_buf
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
 
-enum ASYNC_STATE_BITS {
-    ASYNC_STATE_BIT_RXBUF0_USED = 0,
-    ASYNC_STATE_BIT_RXBUF1_USED,
-};
+// Bit N of the state is set while rx_bufs[N] is in use by the driver.
+#define ASYNC_STATE_BIT_RXBUF_USED(n) (n)
+// Set while the driver asked for the next RX buffer and none was available yet.
+#define ASYNC_STATE_BIT_RXBUF_REQUESTED ZMK_SPLIT_WIRED_ASYNC_RX_BUFS
+
+static int rx_buf_index(const struct zmk_split_wired_async_state *state, const uint8_t *buf) {
+    for (int i = 0; i < ARRAY_SIZE(state->rx_bufs) && state->rx_bufs[i]; i++) {
+        if (state->rx_bufs[i] == buf) {
+            return i;
+        }
+    }
+
+    return -ENOENT;
+}
+
+static bool rx_buf_has_pending_spans(const struct zmk_split_wired_async_state *state, int idx) {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+    return atomic_get(&state->rx_buf_spans[idx]) > 0;
+#else
+    return false;
+#endif
+}
+
+static int claim_rx_buf(struct zmk_split_wired_async_state *state) {
+    for (int i = 0; i < ARRAY_SIZE(state->rx_bufs) && state->rx_bufs[i]; i++) {
+        if (rx_buf_has_pending_spans(state, i)) {
+            continue;
+        }
+
+        if (!atomic_test_and_set_bit(&state->state, ASYNC_STATE_BIT_RXBUF_USED(i))) {
+            return i;
+        }
+    }
+
+    return -ENOMEM;
+}
 
 void zmk_split_wired_async_tx(struct zmk_split_wired_async_state *state) {
     uint8_t *buf;
@@ -150,10 +182,16 @@ void zmk_split_wired_async_tx(struct zmk_split_wired_async_state *state) {
 
 int zmk_split_wired_async_rx(struct zmk_split_wired_async_state *state) {
 
-    atomic_set_bit(&state->state, ASYNC_STATE_BIT_RXBUF0_USED);
-    atomic_clear_bit(&state->state, ASYNC_STATE_BIT_RXBUF1_USED);
+    atomic_clear(&state->state);
+
+    int idx = claim_rx_buf(state);
+    if (idx < 0) {
+        LOG_WRN("No RX buffers available, retrying");
+        k_work_schedule(&state->restart_rx_work, K_MSEC(1));
+        return idx;
+    }
 
-    int ret = uart_rx_enable(state->uart, state->rx_bufs[0], state->rx_bufs_len,
+    int ret = uart_rx_enable(state->uart, state->rx_bufs[idx], state->rx_bufs_len,
                              CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_TIMEOUT);
     if (ret < 0) {
         LOG_ERR("Failed to enable RX (%d)", ret);
@@ -166,6 +204,54 @@ int zmk_split_wired_async_rx_cancel(struct zmk_split_wired_async_state *state) {
     return uart_rx_disable(state->uart);
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
+static void provide_next_rx_buf(struct zmk_split_wired_async_state *state) {
+    int idx = claim_rx_buf(state);
+    if (idx < 0) {
+        atomic_set_bit(&state->state, ASYNC_STATE_BIT_RXBUF_REQUESTED);
+        return;
+    }
+
+    int ret = uart_rx_buf_rsp(state->uart, state->rx_bufs[idx], state->rx_bufs_len);
+    if (ret < 0) {
+        // RX already stopped, and restarting it claims a buffer again.
+        atomic_clear_bit(&state->state, ASYNC_STATE_BIT_RXBUF_USED(idx));
+    }
+}
+
+void zmk_split_wired_async_rx_span_done(struct zmk_split_wired_async_state *state,
+                                        const struct zmk_split_wired_rx_span *span) {
+    if (atomic_dec(&state->rx_buf_spans[span->buf_idx]) == 1 &&
+        atomic_test_and_clear_bit(&state->state, ASYNC_STATE_BIT_RXBUF_REQUESTED)) {
+        provide_next_rx_buf(state);
+    }
+}
+
+static int queue_rx_span(struct zmk_split_wired_async_state *state, const struct uart_event *ev) {
+    int idx = rx_buf_index(state, ev->data.rx.buf);
+    if (idx < 0) {
+        return idx;
+    }
+
+    struct zmk_split_wired_rx_span span = {
+        .data = &ev->data.rx.buf[ev->data.rx.offset],
+        .len = ev->data.rx.len,
+        .buf_idx = idx,
+    };
+
+    atomic_inc(&state->rx_buf_spans[idx]);
+
+    int ret = k_msgq_put(state->rx_spans, &span, K_NO_WAIT);
+    if (ret < 0) {
+        atomic_dec(&state->rx_buf_spans[idx]);
+    }
+
+    return ret;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
 static void restart_rx_work_cb(struct k_work *work) {
     struct k_work_delayable *dwork = k_work_delayable_from_work(work);
     struct zmk_split_wired_async_state *state =
@@ -195,6 +281,23 @@ static void async_uart_cb(const struct device *dev, struct uart_event *ev, void
         }
         break;
     case UART_RX_RDY: {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+        if (state->rx_spans) {
+            if (queue_rx_span(state, ev) < 0) {
+                LOG_ERR("RX overrun!");
+                break;
+            }
+
+            if (state->process_tx_callback) {
+                state->process_tx_callback();
+            } else if (state->process_tx_work) {
+                k_work_submit(state->process_tx_work);
+            }
+
+            break;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
         size_t received =
             ring_buf_put(state->rx_buf, &ev->data.rx.buf[ev->data.rx.offset], ev->data.rx.len);
         if (received < ev->data.rx.len) {
@@ -211,27 +314,32 @@ static void async_uart_cb(const struct device *dev, struct uart_event *ev, void
 
         break;
     }
-    case UART_RX_BUF_RELEASED:
-        if (ev->data.rx_buf.buf == state->rx_bufs[0]) {
-            atomic_clear_bit(&state->state, ASYNC_STATE_BIT_RXBUF0_USED);
-        } else if (ev->data.rx_buf.buf == state->rx_bufs[1]) {
-            atomic_clear_bit(&state->state, ASYNC_STATE_BIT_RXBUF1_USED);
+    case UART_RX_BUF_RELEASED: {
+        int idx = rx_buf_index(state, ev->data.rx_buf.buf);
+        if (idx >= 0) {
+            atomic_clear_bit(&state->state, ASYNC_STATE_BIT_RXBUF_USED(idx));
         }
 
         break;
-    case UART_RX_BUF_REQUEST:
-        if (!atomic_test_and_set_bit(&state->state, ASYNC_STATE_BIT_RXBUF0_USED)) {
-            uart_rx_buf_rsp(state->uart, state->rx_bufs[0], state->rx_bufs_len);
+    }
+    case UART_RX_BUF_REQUEST: {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+        if (state->rx_spans) {
+            // If every free buffer still has spans to dispatch, the last one done is handed over.
+            provide_next_rx_buf(state);
             break;
         }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
 
-        if (!atomic_test_and_set_bit(&state->state, ASYNC_STATE_BIT_RXBUF1_USED)) {
-            uart_rx_buf_rsp(state->uart, state->rx_bufs[1], state->rx_bufs_len);
+        int idx = claim_rx_buf(state);
+        if (idx >= 0) {
+            uart_rx_buf_rsp(state->uart, state->rx_bufs[idx], state->rx_bufs_len);
             break;
         }
 
         LOG_WRN("No RX buffers available!");
         break;
+    }
     case UART_RX_STOPPED:
         // LOG_WRN("UART RX Stopped %d with state %ld", ev->data.rx_stop.reason, state->state);
         break;
@@ -270,58 +378,156 @@ int zmk_split_wired_async_init(struct zmk_split_wired_async_state *state) {
 
 #endif
 
-int zmk_split_wired_get_item(struct ring_buf *rx_buf, uint8_t *env, size_t env_size) {
-    while (ring_buf_size_get(rx_buf) > sizeof(struct msg_prefix) + sizeof(struct msg_postfix)) {
-        struct msg_prefix prefix;
+ssize_t zmk_split_wired_event_data_size(enum zmk_split_transport_peripheral_event_type type) {
+    struct zmk_split_transport_peripheral_event *evt = NULL;
+
+    switch (type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT:
+        return sizeof(evt->data.input_event);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
+        return sizeof(evt->data.key_position_event);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
+        return sizeof(evt->data.sensor_event);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BATTERY_EVENT:
+        return sizeof(evt->data.battery_event);
+    default:
+        return -ENOTSUP;
+    }
+}
+
+#define MAGIC_PREFIX_LEN (sizeof(((struct msg_prefix *)0)->magic_prefix))
+
+// Whether a prefix could start at `data`, given only `len` bytes of it may be visible.
+static bool may_start_prefix(const uint8_t *data, size_t len, const char *magic_prefix) {
+    return memcmp(data, magic_prefix, MIN(len, MAGIC_PREFIX_LEN)) == 0;
+}
+
+static int check_and_dispatch_frame(const uint8_t *frame, size_t frame_len,
+                                    const struct msg_postfix *postfix,
+                                    zmk_split_wired_frame_cb_t cb, void *user_data) {
+    uint32_t crc = crc32_ieee(frame, frame_len);
+    if (crc != postfix->crc) {
+        LOG_WRN("Data corruption in received frame, ignoring %d vs %d", crc, postfix->crc);
+        return -EINVAL;
+    }
+
+    cb(frame, frame_len, user_data);
+
+    return 0;
+}
+
+int zmk_split_wired_parse_frame(const uint8_t *data, size_t len, const char *magic_prefix,
+                                size_t max_frame_len, zmk_split_wired_frame_cb_t cb,
+                                void *user_data, size_t *consumed) {
+    size_t skip = 0;
+    while (skip < len && !may_start_prefix(data + skip, len - skip, magic_prefix)) {
+        skip++;
+    }
+
+    if (skip > 0) {
+        LOG_WRN("Prefix mismatch, discarding %d bytes", skip);
+    }
+
+    *consumed = skip;
+    data += skip;
+    len -= skip;
+
+    if (len < sizeof(struct msg_prefix)) {
+        return -EAGAIN;
+    }
+
+    const struct msg_prefix *prefix = (const struct msg_prefix *)data;
+    size_t frame_len = sizeof(*prefix) + prefix->payload_size;
+
+    if (frame_len > max_frame_len) {
+        // Drop the first byte of the bogus prefix so the next call can resync.
+        *consumed += 1;
+
+        LOG_WRN("Invalid message with payload %d bigger than expected max %d", frame_len,
+                max_frame_len);
+        return -EINVAL;
+    }
+
+    if (len < frame_len + sizeof(struct msg_postfix)) {
+        return -EAGAIN;
+    }
+
+    struct msg_postfix postfix;
+    memcpy(&postfix, data + frame_len, sizeof(postfix));
+    *consumed += frame_len + sizeof(postfix);
+
+    return check_and_dispatch_frame(data, frame_len, &postfix, cb, user_data);
+}
 
-        __ASSERT_EVAL(
-            (void)ring_buf_peek(rx_buf, (uint8_t *)&prefix, sizeof(prefix)),
-            uint32_t peek_read = ring_buf_peek(rx_buf, (uint8_t *)&prefix, sizeof(prefix)),
-            peek_read == sizeof(prefix), "Somehow read less than we expect from the RX buffer");
+/*
+ * Frames are located and checked directly in the ring buffer's storage through a claim, which is
+ * only released once the callback returns. Only a frame that wraps around the end of the storage
+ * is copied out into `scratch` first.
+ */
+int zmk_split_wired_process_frame(struct ring_buf *rx_buf, const char *magic_prefix,
+                                  uint8_t *scratch, size_t scratch_size,
+                                  zmk_split_wired_frame_cb_t cb, void *user_data) {
+    uint32_t available;
+
+    while ((available = ring_buf_size_get(rx_buf)) > MSG_EXTRA_SIZE) {
+        uint8_t *data;
+        uint32_t claimed = ring_buf_get_claim(rx_buf, &data, available);
+
+        size_t consumed;
+        int err = zmk_split_wired_parse_frame(data, claimed, magic_prefix, scratch_size, cb,
+                                              user_data, &consumed);
+        ring_buf_get_finish(rx_buf, consumed);
+
+        if (err != -EAGAIN) {
+            return err;
+        }
 
-        if (memcmp(&prefix.magic_prefix, &ZMK_SPLIT_WIRED_ENVELOPE_MAGIC_PREFIX,
-                   sizeof(prefix.magic_prefix)) != 0) {
-            uint8_t discarded_byte;
-            ring_buf_get(rx_buf, &discarded_byte, 1);
+        if (consumed > 0) {
+            continue;
+        }
 
-            LOG_WRN("Prefix mismatch, discarding byte %0x", discarded_byte);
+        if (claimed == available) {
+            return -EAGAIN;
+        }
 
+        // The next frame wraps around the end of the storage, so copy it out to parse it.
+        struct msg_prefix prefix;
+        ring_buf_peek(rx_buf, (uint8_t *)&prefix, sizeof(prefix));
+        if (!may_start_prefix(prefix.magic_prefix, MAGIC_PREFIX_LEN, magic_prefix)) {
+            ring_buf_get(rx_buf, NULL, 1);
             continue;
         }
 
-        size_t payload_to_read = sizeof(prefix) + prefix.payload_size;
+        size_t frame_len = sizeof(prefix) + prefix.payload_size;
+        if (frame_len > scratch_size) {
+            ring_buf_get(rx_buf, NULL, 1);
 
-        if (payload_to_read > env_size) {
-            LOG_WRN("Invalid message with payload %d bigger than expected max %d", payload_to_read,
-                    env_size);
+            LOG_WRN("Invalid message with payload %d bigger than expected max %d", frame_len,
+                    scratch_size);
             return -EINVAL;
         }
 
-        if (ring_buf_size_get(rx_buf) < payload_to_read + sizeof(struct msg_postfix)) {
+        if (available < frame_len + sizeof(struct msg_postfix)) {
             return -EAGAIN;
         }
 
-        // Now that prefix matches, read it out so we can read the rest of the payload.
-        __ASSERT_EVAL((void)ring_buf_get(rx_buf, env, payload_to_read),
-                      uint32_t read = ring_buf_get(rx_buf, env, payload_to_read),
-                      read == payload_to_read,
-                      "Somehow read less than we expect from the RX buffer");
-
         struct msg_postfix postfix;
-        __ASSERT_EVAL((void)ring_buf_get(rx_buf, (uint8_t *)&postfix, sizeof(postfix)),
-                      uint32_t read = ring_buf_get(rx_buf, (uint8_t *)&postfix, sizeof(postfix)),
-                      read == sizeof(postfix),
-                      "Somehow read less of the postfix than we expect from the RX buffer");
-
-        uint32_t crc = crc32_ieee(env, payload_to_read);
-        if (crc != postfix.crc) {
-            LOG_WRN("Data corruption in received peripheral event, ignoring %d vs %d", crc,
-                    postfix.crc);
-            return -EINVAL;
-        }
+        ring_buf_get(rx_buf, scratch, frame_len);
+        ring_buf_get(rx_buf, (uint8_t *)&postfix, sizeof(postfix));
 
-        return 0;
+        return check_and_dispatch_frame(scratch, frame_len, &postfix, cb, user_data);
     }
 
     return -EAGAIN;
-}
\ No newline at end of file
+}
+
+static void copy_item(const uint8_t *frame, size_t len, void *user_data) {
+    if (frame != user_data) {
+        memcpy(user_data, frame, len);
+    }
+}
+
+int zmk_split_wired_get_item(struct ring_buf *rx_buf, uint8_t *env, size_t env_size) {
+    return zmk_split_wired_process_frame(rx_buf, ZMK_SPLIT_WIRED_ENVELOPE_MAGIC_PREFIX, env,
+                                         env_size, copy_item, env);
+}
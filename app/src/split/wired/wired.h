@@ -12,6 +12,7 @@
 #include <zmk/split/transport/types.h>
 
 #define ZMK_SPLIT_WIRED_ENVELOPE_MAGIC_PREFIX "ZmKw"
+#define ZMK_SPLIT_WIRED_EVENT_FRAME_MAGIC_PREFIX "ZmKb"
 
 struct msg_prefix {
     uint8_t magic_prefix[sizeof(ZMK_SPLIT_WIRED_ENVELOPE_MAGIC_PREFIX) - 1];
@@ -28,16 +29,27 @@ struct command_envelope {
     struct command_payload payload;
 } __packed;
 
-struct event_payload {
+/*
+ * Peripheral events are sent in frames holding every event produced since the last frame, e.g.
+ * all the key position changes of one scan. A frame is a prefix, a header, `count` records each
+ * followed by the event data for its type, and a single CRC postfix over all of it.
+ */
+struct event_frame_header {
     uint8_t source;
-    struct zmk_split_transport_peripheral_event event;
+    uint8_t count;
+    // Time in ms between the first event in the frame and the frame being sent.
+    uint16_t age;
 } __packed;
 
-struct event_envelope {
-    struct msg_prefix prefix;
-    struct event_payload payload;
+struct event_frame_record {
+    // Time in ms between the first event in the frame and this one.
+    uint16_t offset;
+    uint8_t type;
 } __packed;
 
+#define EVENT_FRAME_MAX_PAYLOAD_SIZE UINT8_MAX
+#define EVENT_FRAME_MAX_SIZE (sizeof(struct msg_prefix) + EVENT_FRAME_MAX_PAYLOAD_SIZE)
+
 struct msg_postfix {
     uint32_t crc;
 } __packed;
@@ -67,10 +79,27 @@ void zmk_split_wired_fifo_fill(const struct device *dev, struct ring_buf *tx_buf
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_UART_MODE_ASYNC)
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+#define ZMK_SPLIT_WIRED_ASYNC_RX_BUFS CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_BUFFERS
+#else
+#define ZMK_SPLIT_WIRED_ASYNC_RX_BUFS 2
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
+// A run of received bytes, still in the DMA buffer they were received into.
+struct zmk_split_wired_rx_span {
+    const uint8_t *data;
+    uint16_t len;
+    uint8_t buf_idx;
+};
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
 struct zmk_split_wired_async_state {
     atomic_t state;
 
-    uint8_t *rx_bufs[2];
+    uint8_t *rx_bufs[ZMK_SPLIT_WIRED_ASYNC_RX_BUFS];
     size_t rx_bufs_len;
     size_t rx_size_process_trigger;
 
@@ -84,6 +113,15 @@ struct zmk_split_wired_async_state {
     struct k_work_delayable restart_rx_work;
     struct k_work *process_tx_work;
     const struct gpio_dt_spec *dir_gpio;
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+    /*
+     * When set, received data is queued here as spans of the DMA buffers instead of being copied
+     * into rx_buf. A DMA buffer isn't handed back to the driver until all of its spans are done.
+     */
+    struct k_msgq *rx_spans;
+    atomic_t rx_buf_spans[ZMK_SPLIT_WIRED_ASYNC_RX_BUFS];
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
 };
 
 int zmk_split_wired_async_init(struct zmk_split_wired_async_state *state);
@@ -91,6 +129,30 @@ void zmk_split_wired_async_tx(struct zmk_split_wired_async_state *state);
 int zmk_split_wired_async_rx(struct zmk_split_wired_async_state *state);
 int zmk_split_wired_async_rx_cancel(struct zmk_split_wired_async_state *state);
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
+void zmk_split_wired_async_rx_span_done(struct zmk_split_wired_async_state *state,
+                                        const struct zmk_split_wired_rx_span *span);
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_WIRED_ASYNC_RX_ZERO_COPY)
+
 #endif
 
+ssize_t zmk_split_wired_event_data_size(enum zmk_split_transport_peripheral_event_type type);
+
+/*
+ * Called with a complete frame, starting at its prefix, once its CRC has been checked. The frame
+ * points into the RX ring buffer's storage when it was received contiguously, so it is only valid
+ * for the duration of the call.
+ */
+typedef void (*zmk_split_wired_frame_cb_t)(const uint8_t *frame, size_t len, void *user_data);
+
+int zmk_split_wired_parse_frame(const uint8_t *data, size_t len, const char *magic_prefix,
+                                size_t max_frame_len, zmk_split_wired_frame_cb_t cb,
+                                void *user_data, size_t *consumed);
+
+int zmk_split_wired_process_frame(struct ring_buf *rx_buf, const char *magic_prefix,
+                                  uint8_t *scratch, size_t scratch_size,
+                                  zmk_split_wired_frame_cb_t cb, void *user_data);
+
 int zmk_split_wired_get_item(struct ring_buf *rx_buf, uint8_t *env, size_t env_size);
\ No newline at end of file
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2025 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/timer.h>
+
+static sys_dlist_t pending_timers = SYS_DLIST_STATIC_INIT(&pending_timers);
+static struct k_spinlock lock;
+
+// The timer whose handler is being run by the expiry work.
+static struct zmk_timer *expiring_timer;
+
+// Deadline the expiry work is scheduled for, or ZMK_TIMER_NO_DEADLINE.
+static int64_t scheduled_deadline = ZMK_TIMER_NO_DEADLINE;
+
+static void expiry_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(expiry_work, expiry_work_handler);
+
+static int64_t head_deadline(void) {
+    struct zmk_timer *head = SYS_DLIST_PEEK_HEAD_CONTAINER(&pending_timers, head, node);
+    return head ? head->deadline : ZMK_TIMER_NO_DEADLINE;
+}
+
+// Only move the expiry work when the earliest deadline moves earlier. If it moves later, the work
+// runs early, finds nothing due and is scheduled again for the new head.
+static void schedule_expiry_locked(void) {
+    int64_t deadline = head_deadline();
+    if (deadline == ZMK_TIMER_NO_DEADLINE || deadline >= scheduled_deadline) {
+        return;
+    }
+
+    scheduled_deadline = deadline;
+    k_work_reschedule(&expiry_work, K_MSEC(MAX(deadline - k_uptime_get(), 0)));
+}
+
+static void expiry_work_handler(struct k_work *work) {
+    int64_t now = k_uptime_get();
+
+    K_SPINLOCK(&lock) { scheduled_deadline = ZMK_TIMER_NO_DEADLINE; }
+
+    while (true) {
+        struct zmk_timer *timer = NULL;
+
+        K_SPINLOCK(&lock) {
+            timer = SYS_DLIST_PEEK_HEAD_CONTAINER(&pending_timers, timer, node);
+            if (timer != NULL && timer->deadline <= now) {
+                sys_dlist_remove(&timer->node);
+                expiring_timer = timer;
+            } else {
+                timer = NULL;
+            }
+        }
+
+        if (timer == NULL) {
+            break;
+        }
+
+        timer->handler(timer);
+
+        K_SPINLOCK(&lock) { expiring_timer = NULL; }
+    }
+
+    K_SPINLOCK(&lock) { schedule_expiry_locked(); }
+}
+
+void zmk_timer_init(struct zmk_timer *timer, zmk_timer_handler_t handler) {
+    sys_dnode_init(&timer->node);
+    timer->deadline = ZMK_TIMER_NO_DEADLINE;
+    timer->handler = handler;
+}
+
+void zmk_timer_start_at(struct zmk_timer *timer, int64_t deadline) {
+    K_SPINLOCK(&lock) {
+        if (sys_dnode_is_linked(&timer->node)) {
+            sys_dlist_remove(&timer->node);
+        }
+
+        timer->deadline = deadline;
+
+        struct zmk_timer *next;
+        SYS_DLIST_FOR_EACH_CONTAINER(&pending_timers, next, node) {
+            if (next->deadline > deadline) {
+                break;
+            }
+        }
+
+        if (next != NULL) {
+            sys_dlist_insert(&next->node, &timer->node);
+        } else {
+            sys_dlist_append(&pending_timers, &timer->node);
+        }
+
+        schedule_expiry_locked();
+    }
+}
+
+int zmk_timer_cancel(struct zmk_timer *timer) {
+    int ret = 0;
+
+    K_SPINLOCK(&lock) {
+        if (sys_dnode_is_linked(&timer->node)) {
+            sys_dlist_remove(&timer->node);
+        } else if (expiring_timer == timer && k_current_get() != &k_sys_work_q.thread) {
+            ret = -EINPROGRESS;
+        }
+    }
+
+    return ret;
+}
+
+bool zmk_timer_is_pending(const struct zmk_timer *timer) {
+    bool pending;
+
+    K_SPINLOCK(&lock) { pending = sys_dnode_is_linked(&timer->node); }
+
+    return pending;
+}
+
+int64_t zmk_timer_next_deadline(void) {
+    int64_t deadline;
+
+    K_SPINLOCK(&lock) { deadline = head_deadline(); }
+
+    return deadline;
+}
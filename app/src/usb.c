@@ -61,6 +61,10 @@ void usb_status_cb(enum usb_dc_status_code status, const uint8_t *params) {
         return;
     }
 
+    if (status == USB_DC_RESET || status == USB_DC_DISCONNECTED) {
+        zmk_usb_hid_reset_reports();
+    }
+
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
     if (status == USB_DC_RESET) {
         zmk_usb_hid_set_protocol(HID_PROTOCOL_REPORT);
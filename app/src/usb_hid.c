@@ -23,14 +23,282 @@
 #endif // IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
 
 #include <zmk/event_manager.h>
+#include <zmk/usb_hid.h>
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+#include <zmk/latency.h>
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 static const struct device *hid_dev;
 
-static K_SEM_DEFINE(hid_sem, 1, 1);
+/*
+ * Only one report can be in flight on the interrupt IN endpoint. Reports sent while the endpoint
+ * is busy are queued per report type, and the IN-ready callback writes the next one, so callers
+ * never wait for the host to poll. Each queue keeps the transitions the host must see in order;
+ * reports that don't change the newest queued state are folded into it, and once a queue is full
+ * its newest entry acts as a pending slot that is overwritten with the latest state. Queued
+ * reports carry a sequence number, so reports of different types are written in the order they
+ * were sent.
+ */
+enum usb_hid_report_type {
+    USB_HID_REPORT_KEYBOARD,
+    USB_HID_REPORT_CONSUMER,
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    USB_HID_REPORT_MOUSE,
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+    USB_HID_REPORT_TYPE_COUNT,
+};
+
+union usb_hid_report {
+    struct zmk_hid_keyboard_report keyboard;
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    zmk_hid_boot_report_t boot;
+#endif // IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    struct zmk_hid_consumer_report consumer;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    struct zmk_hid_mouse_report mouse;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
+
+struct usb_hid_queued_report {
+    uint32_t seq;
+    uint8_t len;
+    union usb_hid_report report;
+};
+
+/*
+ * Fold `report` into the already queued report `queued`, returning false if they can't be
+ * combined without losing a state the host should see. With `force`, the queue is full and the
+ * reports must be combined as well as possible.
+ */
+typedef bool (*usb_hid_report_merge_t)(struct usb_hid_queued_report *queued,
+                                       const struct usb_hid_queued_report *report, bool force);
+
+struct usb_hid_report_queue {
+    struct usb_hid_queued_report reports[CONFIG_ZMK_USB_HID_REPORT_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t len;
+};
+
+// A write the host hasn't read after this long is assumed to be lost, e.g. across a host sleep.
+#define IN_FLIGHT_TIMEOUT_MS 30
+
+BUILD_ASSERT(CONFIG_ZMK_USB_HID_REPORT_QUEUE_SIZE > 0 &&
+                 CONFIG_ZMK_USB_HID_REPORT_QUEUE_SIZE <= UINT8_MAX,
+             "USB HID report queue size must be 1-255");
+
+static struct k_spinlock hid_lock;
+static struct usb_hid_report_queue report_queues[USB_HID_REPORT_TYPE_COUNT];
+static struct usb_hid_queued_report in_flight_report;
+static bool in_flight;
+// Set when in_flight_report failed to write; it is then the next report to write.
+static bool in_flight_retry;
+static int64_t in_flight_since;
+static struct zmk_usb_hid_report_stats report_stats;
+static uint32_t next_seq;
+
+static struct usb_hid_queued_report *queue_slot(struct usb_hid_report_queue *queue,
+                                                uint8_t index) {
+    return &queue->reports[index % CONFIG_ZMK_USB_HID_REPORT_QUEUE_SIZE];
+}
+
+// Must be called with hid_lock held.
+static bool dequeue_next_report(struct usb_hid_queued_report *report) {
+    struct usb_hid_report_queue *next = NULL;
+
+    for (int i = 0; i < USB_HID_REPORT_TYPE_COUNT; i++) {
+        struct usb_hid_report_queue *queue = &report_queues[i];
+
+        if (queue->len == 0) {
+            continue;
+        }
+
+        if (!next ||
+            (int32_t)(queue_slot(queue, queue->head)->seq - queue_slot(next, next->head)->seq) <
+                0) {
+            next = queue;
+        }
+    }
+
+    if (!next) {
+        return false;
+    }
+
+    *report = *queue_slot(next, next->head);
+    next->head = (next->head + 1) % CONFIG_ZMK_USB_HID_REPORT_QUEUE_SIZE;
+    next->len--;
+
+    return true;
+}
+
+/*
+ * Write the next queued report, if the endpoint is free. The endpoint write may block on a driver
+ * mutex, so it happens outside hid_lock; claiming in_flight under the lock keeps anyone else from
+ * touching in_flight_report meanwhile. A report that fails to write is kept as the next one to
+ * write, and is retried by the IN-ready callback or the next queued report, so no report is lost
+ * to a busy endpoint.
+ */
+static int write_next_queued_report(void) {
+    k_spinlock_key_t key = k_spin_lock(&hid_lock);
+
+    if (in_flight || (!in_flight_retry && !dequeue_next_report(&in_flight_report))) {
+        k_spin_unlock(&hid_lock, key);
+        return 0;
+    }
+
+    in_flight = true;
+    in_flight_retry = false;
+    in_flight_since = k_uptime_get();
+
+    k_spin_unlock(&hid_lock, key);
+
+    int err = hid_int_ep_write(hid_dev, (const uint8_t *)&in_flight_report.report,
+                               in_flight_report.len, NULL);
+    if (err) {
+        LOG_WRN("Failed to write queued HID report, will retry (%d)", err);
+
+        key = k_spin_lock(&hid_lock);
+        in_flight = false;
+        in_flight_retry = true;
+        k_spin_unlock(&hid_lock, key);
+    }
+
+    return err;
+}
+
+static void in_ready_cb(const struct device *dev) {
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+    zmk_latency_record(ZMK_LATENCY_STAGE_TRANSPORT_COMPLETE);
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_METRICS)
+
+    k_spinlock_key_t key = k_spin_lock(&hid_lock);
+    in_flight = false;
+    k_spin_unlock(&hid_lock, key);
+
+    write_next_queued_report();
+}
+
+static int queue_report(enum usb_hid_report_type type, const void *data, size_t len,
+                        usb_hid_report_merge_t merge) {
+    struct usb_hid_queued_report report = {.len = len};
+    memcpy(&report.report, data, len);
+
+    k_spinlock_key_t key = k_spin_lock(&hid_lock);
+
+    report.seq = next_seq++;
+
+    if (in_flight && k_uptime_get() - in_flight_since > IN_FLIGHT_TIMEOUT_MS) {
+        LOG_WRN("HID report was not read by the host, resuming writes");
+        in_flight = false;
+    }
+
+    struct usb_hid_report_queue *queue = &report_queues[type];
+    struct usb_hid_queued_report *tail =
+        queue->len > 0 ? queue_slot(queue, queue->head + queue->len - 1) : NULL;
+
+    if (in_flight) {
+        report_stats.stalls++;
+    }
+
+    if (tail && merge(tail, &report, false)) {
+        report_stats.coalesced++;
+    } else if (queue->len == CONFIG_ZMK_USB_HID_REPORT_QUEUE_SIZE) {
+        merge(tail, &report, true);
+        tail->seq = report.seq;
+        report_stats.dropped++;
+    } else {
+        *queue_slot(queue, queue->head + queue->len) = report;
+        queue->len++;
+
+        if (in_flight) {
+            report_stats.max_depth = MAX(report_stats.max_depth, queue->len);
+        }
+    }
+
+    k_spin_unlock(&hid_lock, key);
+
+    // The report is queued either way; a failed write is retried later.
+    write_next_queued_report();
+
+    return 0;
+}
+
+// Keyboard and consumer reports are full states, so only exact repeats can be folded.
+static bool merge_state_report(struct usb_hid_queued_report *queued,
+                               const struct usb_hid_queued_report *report, bool force) {
+    if (force) {
+        *queued = *report;
+        return true;
+    }
+
+    return queued->len == report->len &&
+           memcmp(&queued->report, &report->report, report->len) == 0;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+
+static bool add_mouse_delta(int16_t *queued, int16_t delta, bool force) {
+    int32_t sum = (int32_t)*queued + delta;
+
+    if (!force && (sum > INT16_MAX || sum < INT16_MIN)) {
+        return false;
+    }
+
+    *queued = CLAMP(sum, INT16_MIN, INT16_MAX);
+    return true;
+}
+
+// Movement and scrolling are relative, so they accumulate as long as the buttons don't change.
+static bool merge_mouse_report(struct usb_hid_queued_report *queued,
+                               const struct usb_hid_queued_report *report, bool force) {
+    struct zmk_hid_mouse_report_body *q = &queued->report.mouse.body;
+    const struct zmk_hid_mouse_report_body *r = &report->report.mouse.body;
+    struct zmk_hid_mouse_report_body merged = *q;
+
+    if (!force && q->buttons != r->buttons) {
+        return false;
+    }
+
+    merged.buttons = r->buttons;
+    if (!add_mouse_delta(&merged.d_x, r->d_x, force) ||
+        !add_mouse_delta(&merged.d_y, r->d_y, force) ||
+        !add_mouse_delta(&merged.d_scroll_y, r->d_scroll_y, force) ||
+        !add_mouse_delta(&merged.d_scroll_x, r->d_scroll_x, force)) {
+        return false;
+    }
+
+    *q = merged;
+    return true;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
-static void in_ready_cb(const struct device *dev) { k_sem_give(&hid_sem); }
+void zmk_usb_hid_reset_reports(void) {
+    k_spinlock_key_t key = k_spin_lock(&hid_lock);
+
+    for (int i = 0; i < USB_HID_REPORT_TYPE_COUNT; i++) {
+        report_queues[i].head = 0;
+        report_queues[i].len = 0;
+    }
+    in_flight = false;
+    in_flight_retry = false;
+
+    k_spin_unlock(&hid_lock, key);
+}
+
+void zmk_usb_hid_get_report_stats(struct zmk_usb_hid_report_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&hid_lock);
+
+    *stats = report_stats;
+    stats->depth = in_flight_retry ? 1 : 0;
+    for (int i = 0; i < USB_HID_REPORT_TYPE_COUNT; i++) {
+        stats->depth += report_queues[i].len;
+    }
+
+    k_spin_unlock(&hid_lock, key);
+}
 
 #define HID_GET_REPORT_TYPE_MASK 0xff00
 #define HID_GET_REPORT_ID_MASK 0x00ff
@@ -184,7 +452,8 @@ static const struct hid_ops ops = {
     .set_report = set_report_cb,
 };
 
-static int zmk_usb_hid_send_report(const uint8_t *report, size_t len) {
+static int zmk_usb_hid_send_report(enum usb_hid_report_type type, const void *report, size_t len,
+                                   usb_hid_report_merge_t merge) {
     switch (zmk_usb_get_status()) {
     case USB_DC_SUSPEND:
         return usb_wakeup_request();
@@ -194,21 +463,14 @@ static int zmk_usb_hid_send_report(const uint8_t *report, size_t len) {
     case USB_DC_UNKNOWN:
         return -ENODEV;
     default:
-        k_sem_take(&hid_sem, K_MSEC(30));
-        int err = hid_int_ep_write(hid_dev, report, len, NULL);
-
-        if (err) {
-            k_sem_give(&hid_sem);
-        }
-
-        return err;
+        return queue_report(type, report, len, merge);
     }
 }
 
 int zmk_usb_hid_send_keyboard_report(void) {
     size_t len;
     uint8_t *report = get_keyboard_report(&len);
-    return zmk_usb_hid_send_report(report, len);
+    return zmk_usb_hid_send_report(USB_HID_REPORT_KEYBOARD, report, len, merge_state_report);
 }
 
 int zmk_usb_hid_send_consumer_report(void) {
@@ -219,7 +481,8 @@ int zmk_usb_hid_send_consumer_report(void) {
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
     struct zmk_hid_consumer_report *report = zmk_hid_get_consumer_report();
-    return zmk_usb_hid_send_report((uint8_t *)report, sizeof(*report));
+    return zmk_usb_hid_send_report(USB_HID_REPORT_CONSUMER, report, sizeof(*report),
+                                   merge_state_report);
 }
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
@@ -231,7 +494,8 @@ int zmk_usb_hid_send_mouse_report() {
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
     struct zmk_hid_mouse_report *report = zmk_hid_get_mouse_report();
-    return zmk_usb_hid_send_report((uint8_t *)report, sizeof(*report));
+    return zmk_usb_hid_send_report(USB_HID_REPORT_MOUSE, report, sizeof(*report),
+                                   merge_mouse_report);
 }
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 